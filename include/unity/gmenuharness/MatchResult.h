@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <chrono>
 #include <vector>
 #include <memory>
 #include <string>
@@ -47,6 +48,8 @@ public:
 
     void failure(const std::vector<unsigned int>& location, const std::string& message);
 
+    void failure(const std::vector<unsigned int>& parentLocation, unsigned int index, const std::string& message);
+
     void merge(const MatchResult& other);
 
     bool success() const;
@@ -58,6 +61,11 @@ public:
 protected:
     struct Priv;
 
+    bool m_success = true;
+
+    std::chrono::steady_clock::time_point m_deadline;
+
+    /* The failures, only allocated once there is one */
     std::shared_ptr<Priv> p;
 };
 
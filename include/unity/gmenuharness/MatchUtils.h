@@ -19,7 +19,9 @@
 #pragma once
 
 #include <memory>
+#include <set>
 #include <string>
+#include <utility>
 
 #include <gio/gio.h>
 
@@ -33,6 +35,52 @@ void waitForCore(GObject* obj, const std::string& signalName, unsigned int timeo
 
 void menuWaitForItems(const std::shared_ptr<GMenuModel>& menu, unsigned int timeout = 10);
 
+/**
+ * Returns the state of @action in @actionGroup, or nullptr if it has none.
+ *
+ * The states are read from a snapshot of all of the group's action states,
+ * which is taken on first use and then kept up to date by the group's
+ * signals.  All matchers share the snapshot.
+ */
+std::shared_ptr<GVariant> actionGroupGetState(const std::shared_ptr<GActionGroup>& actionGroup, const std::string& action);
+
+/**
+ * Records which actions a match depends on.
+ *
+ * While a recorder exists, it collects the actions whose state is read with
+ * actionGroupGetState(), and the ones that matchers change themselves (see
+ * recordChange()).  Only the most recently created recorder records.
+ */
+class ActionRecorder
+{
+public:
+    typedef std::pair<GActionGroup*, std::string> Action;
+
+    ActionRecorder();
+
+    ~ActionRecorder();
+
+    ActionRecorder(const ActionRecorder& other) = delete;
+
+    ActionRecorder& operator=(const ActionRecorder& other) = delete;
+
+    const std::set<Action>& read() const;
+
+    const std::set<Action>& changed() const;
+
+    static void recordRead(GActionGroup* actionGroup, const std::string& action);
+
+    /* To be called before activating @action or changing its state */
+    static void recordChange(GActionGroup* actionGroup, const std::string& action);
+
+protected:
+    std::set<Action> m_read;
+
+    std::set<Action> m_changed;
+
+    ActionRecorder* m_previous;
+};
+
 void g_object_deleter(gpointer object);
 
 void gvariant_deleter(GVariant* varptr);
@@ -36,17 +36,24 @@ public class AccountsServiceAccess : Object
 	private double _volume = 0.0;
 	private string _last_running_player = "";
 	private bool _mute = false;
-	private Cancellable _dbus_call_cancellable;
+
+	/* Sound proxies of the users looked at last, most recently used first */
+	private const uint MAX_USER_PROXIES = 8;
+	private DBusProxy _accounts_proxy = null;
+	private HashTable<string, DBusProxy> _user_proxies = new HashTable<string, DBusProxy> (str_hash, str_equal);
+	private Queue<string> _user_proxies_lru = new Queue<string> ();
+	private string? _selected_user = null;
+
+	private HashTable<string, PropertyWrite> _property_writes = new HashTable<string, PropertyWrite> (str_hash, str_equal);
 
 	public AccountsServiceAccess ()
 	{
-		_dbus_call_cancellable = new Cancellable ();
 		setup_accountsservice.begin ();
 	}
 
 	~AccountsServiceAccess ()
 	{
-		_dbus_call_cancellable.cancel ();
+		cancel_property_writes ();
 	}
 
 	public string last_running_player 
@@ -57,7 +64,7 @@ public class AccountsServiceAccess : Object
 		} 
 		set 
 		{ 
-			sync_last_running_player_to_accountsservice.begin (value);
+			sync_last_running_player_to_accountsservice (value);
 		} 
 	}
 
@@ -69,7 +76,7 @@ public class AccountsServiceAccess : Object
 		} 
 		set 
 		{ 
-			sync_mute_to_accountsservice.begin (value);
+			sync_mute_to_accountsservice (value);
 		} 
 	}
 
@@ -81,7 +88,7 @@ public class AccountsServiceAccess : Object
 		} 
 		set 
 		{ 
-			sync_volume_to_accountsservice.begin (value);
+			sync_volume_to_accountsservice (value);
 		} 
 	}
 
@@ -113,7 +120,13 @@ public class AccountsServiceAccess : Object
 	private async void setup_user_proxy (string? username_in = null)
 	{
 		var username = username_in;
+
+		if (_user_proxy != null) {
+			_user_proxy.g_properties_changed.disconnect (accountsservice_props_changed_cb);
+			cancel_property_writes ();
+		}
 		_user_proxy = null;
+		_selected_user = username;
 
 		// Look up currently selected greeter user, if asked
 		if (username == null) {
@@ -125,49 +138,120 @@ public class AccountsServiceAccess : Object
 				warning ("unable to find Accounts path for user %s: %s", username == null ? "null" : username, e.message);
 				return;
 			}
+
+			// The selection changed while we were asking
+			if (_selected_user != null)
+				return;
+			_selected_user = username;
 		}
 
+		var user_proxy = _user_proxies.lookup (username);
+		bool cached = user_proxy != null;
+		if (cached) {
+			_user_proxies_lru.delete_link (_user_proxies_lru.find_custom (username, strcmp));
+			_user_proxies_lru.push_head (username);
+		} else {
+			user_proxy = yield create_user_proxy (username);
+			if (user_proxy == null)
+				return;
+
+			_user_proxies.insert (username, user_proxy);
+			_user_proxies_lru.push_head (username);
+			while (_user_proxies_lru.get_length () > MAX_USER_PROXIES)
+				_user_proxies.remove (_user_proxies_lru.pop_tail ());
+
+			// The selection moved on while we were creating the proxy
+			if (_selected_user != username)
+				return;
+		}
+
+		// Use the last known values right away, and listen for changes
+		_user_proxy = user_proxy;
+		_user_proxy.g_properties_changed.connect (accountsservice_props_changed_cb);
+		apply_cached_properties (_user_proxy);
+
+		// A proxy from the cache could have missed changes, check them in the
+		// background.  A new one has just loaded its properties.
+		if (cached)
+			yield refresh_user_properties (_user_proxy, username);
+	}
+
+	private async DBusProxy? get_accounts_proxy ()
+	{
+		if (_accounts_proxy != null)
+			return _accounts_proxy;
+
 		// Get master AccountsService object
-		DBusProxy accounts_proxy;
 		try {
-			accounts_proxy = yield DBusProxy.create_for_bus (BusType.SYSTEM, DBusProxyFlags.DO_NOT_LOAD_PROPERTIES | DBusProxyFlags.DO_NOT_CONNECT_SIGNALS, null, "org.freedesktop.Accounts", "/org/freedesktop/Accounts", "org.freedesktop.Accounts");
+			_accounts_proxy = yield DBusProxy.create_for_bus (BusType.SYSTEM, DBusProxyFlags.DO_NOT_LOAD_PROPERTIES | DBusProxyFlags.DO_NOT_CONNECT_SIGNALS, null, "org.freedesktop.Accounts", "/org/freedesktop/Accounts", "org.freedesktop.Accounts");
 		} catch (GLib.Error e) {
 			warning ("unable to get greeter proxy: %s", e.message);
-			return;
 		}
 
+		return _accounts_proxy;
+	}
+
+	private async DBusProxy? create_user_proxy (string username)
+	{
+		var accounts_proxy = yield get_accounts_proxy ();
+		if (accounts_proxy == null)
+			return null;
+
 		// Find user's AccountsService object
 		try {
 			var user_path_variant = yield accounts_proxy.call ("FindUserByName", new Variant ("(s)", username), DBusCallFlags.NONE, -1);
 			string user_path;
 			if (user_path_variant.check_format_string ("(o)", true)) {
 				user_path_variant.get ("(o)", out user_path);
-				_user_proxy = yield DBusProxy.create_for_bus (BusType.SYSTEM, DBusProxyFlags.GET_INVALIDATED_PROPERTIES, null, "org.freedesktop.Accounts", user_path, "com.ubuntu.AccountsService.Sound");
+				return yield DBusProxy.create_for_bus (BusType.SYSTEM, DBusProxyFlags.GET_INVALIDATED_PROPERTIES, null, "org.freedesktop.Accounts", user_path, "com.ubuntu.AccountsService.Sound");
 			} else {
 				warning ("Unable to find user name after calling FindUserByName. Expected type: %s and obtained %s", "(o)", user_path_variant.get_type_string () );
-				return;
 			}
 		} catch (GLib.Error e) {
 			warning ("unable to find Accounts path for user %s: %s", username, e.message);
-			return;
 		}
 
-		// Get current values and listen for changes
-		_user_proxy.g_properties_changed.connect (accountsservice_props_changed_cb);
+		return null;
+	}
+
+	/* Cached proxies keep their properties up to date while they aren't the
+	   selected one, so they can be applied without a round trip */
+	private void apply_cached_properties (DBusProxy user_proxy)
+	{
+		var builder = new VariantBuilder (VariantType.VARDICT);
+		foreach (var name in user_proxy.get_cached_property_names ()) {
+			var value = user_proxy.get_cached_property (name);
+			if (value != null)
+				builder.add ("{sv}", name, value);
+		}
+
+		accountsservice_props_changed_cb (user_proxy, builder.end (), null);
+	}
+
+	private async void refresh_user_properties (DBusProxy user_proxy, string username)
+	{
 		try {
-			var props_variant = yield _user_proxy.get_connection ().call (_user_proxy.get_name (), _user_proxy.get_object_path (), "org.freedesktop.DBus.Properties", "GetAll", new Variant ("(s)", _user_proxy.get_interface_name ()), null, DBusCallFlags.NONE, -1);
+			var props_variant = yield user_proxy.get_connection ().call (user_proxy.get_name (), user_proxy.get_object_path (), "org.freedesktop.DBus.Properties", "GetAll", new Variant ("(s)", user_proxy.get_interface_name ()), null, DBusCallFlags.NONE, -1);
 			if (props_variant.check_format_string ("(@a{sv})", true)) {
 				Variant props;
 				props_variant.get ("(@a{sv})", out props);
-				accountsservice_props_changed_cb(_user_proxy, props, null);
+
+				foreach (var prop in props) {
+					string name;
+					Variant value;
+					prop.get ("{sv}", out name, out value);
+					user_proxy.set_cached_property (name, value);
+				}
+
+				if (user_proxy == _user_proxy)
+					accountsservice_props_changed_cb(user_proxy, props, null);
 			} else {
 				warning ("Unable to get accounts service properties after calling GetAll. Expected type: %s and obtained %s", "(@a{sv})", props_variant.get_type_string () );
-				return;
 			}
 		} catch (GLib.Error e) {
 			debug("Unable to get properties for user %s at first try: %s", username, e.message);
 		}
-	}	
+	}
 
 	private void greeter_user_changed (string username)
 	{
@@ -194,41 +278,117 @@ public class AccountsServiceAccess : Object
 		}
 	}
 
-	private async void sync_last_running_player_to_accountsservice (string last_running_player)
+	private void sync_last_running_player_to_accountsservice (string last_running_player)
 	{
 		if (_user_proxy == null)
 			return;
 
-		try {
-			yield _user_proxy.get_connection ().call (_user_proxy.get_name (), _user_proxy.get_object_path (), "org.freedesktop.DBus.Properties", "Set", new Variant ("(ssv)", _user_proxy.get_interface_name (), "LastRunningPlayer", new Variant ("s", last_running_player)), null, DBusCallFlags.NONE, -1, _dbus_call_cancellable);
-		} catch (GLib.Error e) {
-			warning ("unable to sync last running player %s to AccountsService: %s",last_running_player, e.message);
-		}
+		write_property ("LastRunningPlayer", new Variant ("s", last_running_player));
 		_last_running_player = last_running_player;
 	}
 
-	private async void sync_volume_to_accountsservice (double volume)
+	private void sync_volume_to_accountsservice (double volume)
+	{
+		write_property ("Volume", new Variant ("d", volume));
+	}
+
+	private void sync_mute_to_accountsservice (bool mute)
+	{
+		write_property ("Muted", new Variant ("b", mute));
+	}
+
+	/* Writes of one property.  At most one Set call is in flight, and only
+	   the latest value written while it is keeps waiting behind it.  They
+	   are all meant for the selected user: switching users drops them. */
+	[Compact]
+	private class PropertyWrite {
+		public Cancellable? cancellable = null;
+		public Variant? pending = null;
+	}
+
+	private void write_property (string name, Variant value)
 	{
 		if (_user_proxy == null)
 			return;
 
-		try {
-			yield _user_proxy.get_connection ().call (_user_proxy.get_name (), _user_proxy.get_object_path (), "org.freedesktop.DBus.Properties", "Set", new Variant ("(ssv)", _user_proxy.get_interface_name (), "Volume", new Variant ("d", volume)), null, DBusCallFlags.NONE, -1, _dbus_call_cancellable);
-		} catch (GLib.Error e) {
-			warning ("unable to sync volume %f to AccountsService: %s", volume, e.message);
+		unowned PropertyWrite? write = _property_writes.lookup (name);
+		if (write == null) {
+			var new_write = new PropertyWrite ();
+			write = new_write;
+			_property_writes.insert (name, (owned) new_write);
+		}
+
+		if (write.cancellable != null) {
+			if (write.pending != null)
+				IndicatorSound.DebugMetrics.increment ("accounts-service-access-superseded");
+			write.pending = value;
+			update_write_metrics ();
+			return;
 		}
+
+		write.pending = value;
+		send_property.begin (name);
 	}
 
-	private async void sync_mute_to_accountsservice (bool mute)
+	private async void send_property (string name)
 	{
-		if (_user_proxy == null)
-			return;
+		unowned PropertyWrite write = _property_writes.lookup (name);
+		var proxy = _user_proxy;
+		var value = (owned) write.pending;
+		var cancellable = new Cancellable ();
+
+		write.cancellable = cancellable;
+		update_write_metrics ();
 
 		try {
-			yield _user_proxy.get_connection ().call (_user_proxy.get_name (), _user_proxy.get_object_path (), "org.freedesktop.DBus.Properties", "Set", new Variant ("(ssv)", _user_proxy.get_interface_name (), "Muted", new Variant ("b", mute)), null, DBusCallFlags.NONE, -1, _dbus_call_cancellable);
+			yield proxy.get_connection ().call (proxy.get_name (), proxy.get_object_path (), "org.freedesktop.DBus.Properties", "Set", new Variant ("(ssv)", proxy.get_interface_name (), name, value), null, DBusCallFlags.NONE, -1, cancellable);
 		} catch (GLib.Error e) {
-			warning ("unable to sync mute %s to AccountsService: %s", mute ? "true" : "false", e.message);
+			if (!(e is IOError.CANCELLED))
+				warning ("unable to sync %s %s to AccountsService: %s", name, value.print (false), e.message);
 		}
+
+		if (cancellable.is_cancelled ())
+			return;
+
+		// write can't have gone away: entries are never removed
+		write = _property_writes.lookup (name);
+		write.cancellable = null;
+
+		// Only the user the value was written for may get it
+		if (write.pending != null && proxy == _user_proxy)
+			send_property.begin (name);
+		else
+			write.pending = null;
+
+		update_write_metrics ();
+	}
+
+	private void cancel_property_writes ()
+	{
+		_property_writes.foreach ((name, write) => {
+			if (write.cancellable != null)
+				write.cancellable.cancel ();
+			write.cancellable = null;
+			write.pending = null;
+		});
+
+		update_write_metrics ();
+	}
+
+	private void update_write_metrics ()
+	{
+		int64 in_flight = 0;
+		int64 queued = 0;
+
+		_property_writes.foreach ((name, write) => {
+			if (write.cancellable != null)
+				in_flight++;
+			if (write.pending != null)
+				queued++;
+		});
+
+		IndicatorSound.DebugMetrics.set_value ("accounts-service-access-in-flight", in_flight);
+		IndicatorSound.DebugMetrics.set_value ("accounts-service-access-queued", queued);
 	}
 }
 
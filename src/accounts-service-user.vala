@@ -18,13 +18,24 @@
  */
 
 public class AccountsServiceUser : Object {
+	const uint EXPORT_DELAY_MS = 100;
+	const string[] SCREENSAVER_INTERFACES = {
+		"org.gnome.ScreenSaver",
+		"org.cinnamon.ScreenSaver",
+		"org.mate.ScreenSaver",
+		"org.freedesktop.ScreenSaver"
+	};
+
 	Act.UserManager accounts_manager = Act.UserManager.get_default();
 	Act.User? user = null;
 	AccountsServiceSoundSettings? proxy = null;
 	AccountsServicePrivacySettings? privacyproxy = null;
 	AccountsServiceSystemSoundSettings? syssoundproxy = null;
-	uint timer = 0;
+	uint export_timer = 0;
+	uint[] screensaver_subscriptions = {};
 	MediaPlayer? _player = null;
+	/* Values as last written to Accounts Service, by property name */
+	HashTable<string, Variant> exported = new HashTable<string, Variant>(str_hash, str_equal);
 	GreeterBroadcast? greeter = null;
 
 	public bool showDataOnGreeter { get; set; }
@@ -52,66 +63,127 @@ public class AccountsServiceUser : Object {
 				return;
 			}
 
-			/* Always reset the timer */
-			if (this.timer != 0) {
-				GLib.Source.remove(this.timer);
-				this.timer = 0;
-			}
-
-			if (this._player == null) {
-				debug("Clearing player data in accounts service");
+			/* Coalesce bursts of changes, like skipping through a playlist */
+			if (this.export_timer == 0)
+				this.export_timer = GLib.Timeout.add(EXPORT_DELAY_MS, export_player);
+		}
+		get {
+			return this._player;
+		}
+	}
 
-				/* Clear it */
-				this.proxy.player_name = "";
-				this.proxy.timestamp = 0;
-				this.proxy.title = "";
-				this.proxy.artist = "";
-				this.proxy.album = "";
-				this.proxy.art_url = "";
+	bool export_player () {
+		this.export_timer = 0;
+		write_player();
+		return GLib.Source.REMOVE;
+	}
 
+	/* Only the fields that changed since the last write are sent */
+	void write_player () {
+		bool changed = false;
+
+		if (this._player == null) {
+			debug("Clearing player data in accounts service");
+
+			/* Clear it */
+			changed |= export_property("PlayerName", new Variant.string(""));
+			changed |= export_property("Title", new Variant.string(""));
+			changed |= export_property("Artist", new Variant.string(""));
+			changed |= export_property("Album", new Variant.string(""));
+			changed |= export_property("ArtUrl", new Variant.string(""));
+
+			var icon = new ThemedIcon.with_default_fallbacks ("application-default-icon");
+			changed |= export_property("PlayerIcon", new Variant.variant(icon.serialize()));
+
+			if (changed)
+				export_property("Timestamp", new Variant.uint64(0));
+		} else {
+			changed |= export_property("PlayerName", new Variant.string(this._player.name));
+
+			/* Serialize the icon if it exits, if it doesn't or errors then
+			   we need to use the application default icon */
+			GLib.Variant? icon_serialization = null;
+			if (this._player.icon != null)
+				icon_serialization = this._player.icon.serialize();
+			if (icon_serialization == null) {
 				var icon = new ThemedIcon.with_default_fallbacks ("application-default-icon");
-				this.proxy.player_icon = icon.serialize();
+				icon_serialization = icon.serialize();
+			}
+			changed |= export_property("PlayerIcon", new Variant.variant(icon_serialization));
+
+			/* Set state of the player */
+			changed |= export_property("Running", new Variant.boolean(this._player.is_running));
+			changed |= export_property("State", new Variant.string(this._player.state));
+
+			if (this._player.current_track != null) {
+				changed |= export_property("Title", new Variant.string(this._player.current_track.title));
+				changed |= export_property("Artist", new Variant.string(this._player.current_track.artist));
+				changed |= export_property("Album", new Variant.string(this._player.current_track.album));
+				/* The greeter runs as another user, which can't read our cache */
+				changed |= export_property("ArtUrl", new Variant.string(this._player.current_track.art_url));
 			} else {
-				this.proxy.timestamp = GLib.get_monotonic_time();
-				this.proxy.player_name = this._player.name;
-
-				/* Serialize the icon if it exits, if it doesn't or errors then
-				   we need to use the application default icon */
-				GLib.Variant? icon_serialization = null;
-				if (this._player.icon != null)
-					icon_serialization = this._player.icon.serialize();
-				if (icon_serialization == null) {
-					var icon = new ThemedIcon.with_default_fallbacks ("application-default-icon");
-					icon_serialization = icon.serialize();
-				}
-				this.proxy.player_icon = icon_serialization;
-
-				/* Set state of the player */
-				this.proxy.running = this._player.is_running;
-				this.proxy.state = this._player.state;
-
-				if (this._player.current_track != null) {
-					this.proxy.title = this._player.current_track.title;
-					this.proxy.artist = this._player.current_track.artist;
-					this.proxy.album = this._player.current_track.album;
-					this.proxy.art_url = this._player.current_track.art_url;
-				} else {
-					this.proxy.title = "";
-					this.proxy.artist = "";
-					this.proxy.album = "";
-					this.proxy.art_url = "";
-				}
-
-				this.timer = GLib.Timeout.add_seconds(5 * 60, () => {
-					debug("Writing timestamp");
-					this.proxy.timestamp = GLib.get_monotonic_time();
-					return true;
-				});
+				changed |= export_property("Title", new Variant.string(""));
+				changed |= export_property("Artist", new Variant.string(""));
+				changed |= export_property("Album", new Variant.string(""));
+				changed |= export_property("ArtUrl", new Variant.string(""));
 			}
+
+			/* There is no heartbeat: the greeter trusts the data for as long
+			   as this session exists */
+			if (changed)
+				export_property("Timestamp", new Variant.uint64(GLib.get_monotonic_time()));
 		}
-		get {
-			return this._player;
-		}
+	}
+
+	/* The greeter shows the player of a locked session, so make sure the
+	   timestamp is fresh when the screen locks */
+	void screensaver_active_changed (DBusConnection connection, string? sender, string object_path, string interface_name, string signal_name, Variant parameters) {
+		bool active = false;
+		parameters.get("(b)", out active);
+
+		if (!active || this.proxy == null || this._player == null)
+			return;
+
+		debug("Session locked, writing timestamp");
+		export_property("Timestamp", new Variant.uint64(GLib.get_monotonic_time()));
+	}
+
+	/* Accounts Service has no call to set several properties at once, so each
+	   changed property is its own Set call.  They are sent without waiting for
+	   the replies, so that a whole update takes a single round trip. */
+	bool export_property (string name, Variant value) {
+		unowned Variant? old = this.exported.lookup(name);
+		if (old != null && old.equal(value))
+			return false;
+
+		this.exported.insert(name, value);
+		IndicatorSound.DebugMetrics.increment("accounts-service-writes");
+
+		var dbusproxy = this.proxy as DBusProxy;
+		dbusproxy.get_connection().call.begin(
+			dbusproxy.get_name(),
+			dbusproxy.get_object_path(),
+			"org.freedesktop.DBus.Properties",
+			"Set",
+			new Variant("(ssv)", dbusproxy.get_interface_name(), name, value),
+			null,
+			DBusCallFlags.NONE,
+			-1,
+			null,
+			(obj, res) => {
+				try {
+					(obj as DBusConnection).call.end(res);
+				} catch (Error e) {
+					warning("Unable to write to Accounts Service: %s", e.message);
+
+					/* It wasn't written after all, the next update has to try again */
+					unowned Variant? current = this.exported.lookup(name);
+					if (current != null && current.equal(value))
+						this.exported.remove(name);
+				}
+			});
+
+		return true;
 	}
 
 	public AccountsServiceUser () {
@@ -119,6 +191,22 @@ public class AccountsServiceUser : Object {
 		user.notify["is-loaded"].connect(() => user_loaded_changed());
 		user_loaded_changed();
 
+		/* GNOME, Cinnamon, MATE and freedesktop screensavers all emit ActiveChanged */
+		try {
+			var session = Bus.get_sync(BusType.SESSION);
+			foreach (var iface in SCREENSAVER_INTERFACES) {
+				screensaver_subscriptions += session.signal_subscribe(null,
+					iface,
+					"ActiveChanged",
+					null,
+					null,
+					DBusSignalFlags.NONE,
+					screensaver_active_changed);
+			}
+		} catch (Error e) {
+			warning("Unable to watch the screensaver: %s", e.message);
+		}
+
 		Bus.get_proxy.begin<GreeterBroadcast> (
 			BusType.SYSTEM,
 			"com.canonical.Unity.Greeter.Broadcast",
@@ -162,17 +250,32 @@ public class AccountsServiceUser : Object {
 
 	~AccountsServiceUser () {
 		debug("Account Service Object Finalizing");
-		this.player = null;
 
-		if (this.timer != 0) {
-			GLib.Source.remove(this.timer);
-			this.timer = 0;
+		if (this.export_timer != 0) {
+			GLib.Source.remove(this.export_timer);
+			this.export_timer = 0;
+		}
+
+		this._player = null;
+		if (this.proxy != null)
+			write_player();
+
+		if (this.screensaver_subscriptions.length > 0) {
+			try {
+				var session = Bus.get_sync(BusType.SESSION);
+				foreach (var id in this.screensaver_subscriptions)
+					session.signal_unsubscribe(id);
+			} catch (Error e) {
+				warning("Unable to stop watching the screensaver: %s", e.message);
+			}
+			this.screensaver_subscriptions = {};
 		}
 	}
 
 	void new_sound_proxy (GLib.Object? obj, AsyncResult res) {
 		try {
 			this.proxy = Bus.get_proxy.end (res);
+			this.exported.remove_all();
 			this.player = _player;
 		} catch (Error e) {
 			this.proxy = null;
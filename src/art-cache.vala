@@ -0,0 +1,225 @@
+/*
+ * Copyright 2016 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * ArtCache turns local album art (file:// and data: urls) into small thumbnails in the
+ * user's cache directory, so that panels don't have to load full-size covers on every
+ * track change.  The thumbnails can only be read by the user, so urls that are handed
+ * to other users (like the greeter) should not be looked up here.
+ *
+ * Thumbnails are named after a hash of the image data and are generated by a few
+ * worker threads shared by all caches.  Only the most recently used MAX_FILES
+ * thumbnails are kept.
+ */
+public class ArtCache : Object {
+	const int THUMBNAIL_SIZE = 128;
+	const uint MAX_ENTRIES = 64;
+	const uint MAX_FILES = 256;
+	const int MAX_WORKERS = 2;
+
+	static ArtCache? default_cache = null;
+
+	public static ArtCache get_default () {
+		if (default_cache == null)
+			default_cache = new ArtCache ();
+		return default_cache;
+	}
+
+	public ArtCache (string? cache_dir = null) {
+		if (cache_dir != null)
+			this.cache_dir = cache_dir;
+		else
+			this.cache_dir = Path.build_filename (Environment.get_user_cache_dir (), "indicator-sound", "art");
+
+		this.urls = new HashTable<string, string> (str_hash, str_equal);
+		this.urls_order = new Queue<string> ();
+		this.pending = new HashTable<string, bool> (str_hash, str_equal);
+	}
+
+	/**
+	 * Emitted when the url to export for @art_url has changed, because its thumbnail
+	 * was generated (or could not be generated).
+	 */
+	public signal void thumbnail_ready (string art_url);
+
+	/**
+	 * Returns the url that should be exported in place of @art_url.
+	 *
+	 * Urls that can't be cached are returned unchanged.  For local art, this is the
+	 * thumbnail's url once it has been generated.  Until then, file:// urls are returned
+	 * unchanged and data: urls are withheld (""), as they are expensive to pass around.
+	 */
+	public string lookup (string art_url) {
+		if (!is_cacheable (art_url))
+			return art_url;
+
+		unowned string? url = this.urls.lookup (art_url);
+		if (url != null)
+			return url;
+
+		if (!this.pending.contains (art_url)) {
+			this.pending.insert (art_url, true);
+			this.generate.begin (art_url);
+		}
+
+		return fallback_url (art_url);
+	}
+
+	string cache_dir;
+	HashTable<string, string> urls;
+	Queue<string> urls_order; /* keys of urls, oldest first */
+	HashTable<string, bool> pending;
+
+	class ThumbnailJob {
+		public string art_url;
+		public string cache_dir;
+		public string? thumbnail = null;
+		public SourceFunc callback;
+	}
+
+	static ThreadPool<ThumbnailJob>? workers = null;
+
+	static ThreadPool<ThumbnailJob> get_workers () throws ThreadError {
+		if (workers == null) {
+			workers = new ThreadPool<ThumbnailJob>.with_owned_data ((job) => {
+				job.thumbnail = create_thumbnail (job.art_url, job.cache_dir);
+				Idle.add ((owned) job.callback);
+			}, MAX_WORKERS, false);
+		}
+		return workers;
+	}
+
+	static bool is_cacheable (string art_url) {
+		return art_url.has_prefix ("file://") || art_url.has_prefix ("data:");
+	}
+
+	static string fallback_url (string art_url) {
+		return art_url.has_prefix ("data:") ? "" : art_url;
+	}
+
+	async void generate (string art_url) {
+		var job = new ThumbnailJob ();
+		job.art_url = art_url;
+		job.cache_dir = this.cache_dir;
+		job.callback = generate.callback;
+
+		try {
+			/* skipping through a playlist queues up jobs rather than threads */
+			get_workers ().add (job);
+			yield;
+		}
+		catch (ThreadError e) {
+			warning ("unable to start a thread for album art thumbnails: %s", e.message);
+		}
+
+		/* the table only grows with the number of distinct tracks, keep it bounded */
+		if (this.urls.size () >= MAX_ENTRIES)
+			this.urls.remove (this.urls_order.pop_head ());
+
+		/* failures are remembered too, so that broken art isn't retried on every lookup */
+		this.urls.insert (art_url, job.thumbnail != null ? job.thumbnail : fallback_url (art_url));
+		this.urls_order.push_tail (art_url);
+		this.pending.remove (art_url);
+
+		this.thumbnail_ready (art_url);
+	}
+
+	/* Runs in a worker thread: must not touch any instance state */
+	static string? create_thumbnail (string art_url, string cache_dir) {
+		try {
+			uint8[] data;
+			if (art_url.has_prefix ("data:"))
+				data = decode_data_url (art_url);
+			else
+				FileUtils.get_data (Filename.from_uri (art_url), out data);
+
+			var path = Path.build_filename (cache_dir, Checksum.compute_for_data (ChecksumType.SHA1, data) + ".png");
+			var file = File.new_for_path (path);
+
+			if (FileUtils.test (path, FileTest.EXISTS)) {
+				/* keep it from being pruned */
+				file.set_attribute_uint64 (FileAttribute.TIME_MODIFIED, get_real_time () / 1000000, FileQueryInfoFlags.NONE);
+			}
+			else {
+				var loader = new Gdk.PixbufLoader ();
+				loader.size_prepared.connect ((l, width, height) => {
+					if (width > THUMBNAIL_SIZE || height > THUMBNAIL_SIZE) {
+						double scale = double.min ((double) THUMBNAIL_SIZE / width, (double) THUMBNAIL_SIZE / height);
+						l.set_size (int.max ((int) (width * scale), 1), int.max ((int) (height * scale), 1));
+					}
+				});
+				loader.write (data);
+				loader.close ();
+
+				uint8[] png;
+				loader.get_pixbuf ().save_to_bufferv (out png, "png", null, null);
+
+				/* replace() writes to a temporary file of its own and renames it when done, so
+				   readers never see half-written thumbnails, even when several threads create
+				   the same one */
+				DirUtils.create_with_parents (cache_dir, 0755);
+				file.replace_contents (png, null, false, FileCreateFlags.NONE, null);
+
+				prune (cache_dir);
+			}
+
+			return Filename.to_uri (path);
+		}
+		catch (Error e) {
+			debug ("unable to create thumbnail for album art: %s", e.message);
+			return null;
+		}
+	}
+
+	/* Runs in a worker thread: removes the least recently used thumbnails beyond MAX_FILES */
+	static void prune (string cache_dir) {
+		var files = new GenericArray<FileInfo> ();
+		try {
+			var dir = File.new_for_path (cache_dir);
+			var enumerator = dir.enumerate_children (FileAttribute.STANDARD_NAME + "," + FileAttribute.TIME_MODIFIED, FileQueryInfoFlags.NONE);
+			FileInfo? info;
+			while ((info = enumerator.next_file ()) != null) {
+				if (info.get_name ().has_suffix (".png"))
+					files.add (info);
+			}
+		}
+		catch (Error e) {
+			debug ("unable to list album art thumbnails: %s", e.message);
+			return;
+		}
+
+		if (files.length <= MAX_FILES)
+			return;
+
+		files.sort ((a, b) => {
+			uint64 ta = a.get_attribute_uint64 (FileAttribute.TIME_MODIFIED);
+			uint64 tb = b.get_attribute_uint64 (FileAttribute.TIME_MODIFIED);
+			return ta < tb ? -1 : (ta > tb ? 1 : 0);
+		});
+
+		/* another thread may be pruning too, files that are gone already don't matter */
+		for (uint i = 0; i < files.length - MAX_FILES; i++)
+			FileUtils.unlink (Path.build_filename (cache_dir, files[i].get_name ()));
+	}
+
+	static uint8[] decode_data_url (string url) throws Error {
+		int comma = url.index_of_char (',');
+		if (comma < 0 || !url.substring (0, comma).has_suffix (";base64"))
+			throw new IOError.NOT_SUPPORTED ("only base64-encoded data urls are supported");
+
+		return Base64.decode (url.substring (comma + 1));
+	}
+}
@@ -0,0 +1,187 @@
+/*
+ * Copyright 2016 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * A menu model with the same mutators as GLib.Menu, which can also replace
+ * an item in place and batch changes.  GLib.Menu emits items-changed for
+ * every single mutation, and every emission is a separate update for each
+ * client of an exported menu.
+ *
+ * Between begin() and commit(), the items-changed emissions of all
+ * BatchedMenus are held back.  Mutations are applied right away, so code in
+ * the transaction reads its own changes.  At commit(), each menu that changed
+ * emits one items-changed covering all of its changes.  Transactions must not
+ * span main loop iterations, so that nobody else can read the menus before
+ * being told about the changes.
+ *
+ * Sections and submenus emit before the menus linking to them: whoever reads
+ * a new section when its parent changes must not be told about its contents
+ * a second time afterwards.
+ */
+public class BatchedMenu : MenuModel {
+	/* The items are kept in a GLib.Menu that nobody else sees */
+	Menu items = new Menu ();
+
+	/* While in a transaction: whether there are changes to emit, the number
+	 * of items before the first change, and the number of items at the start
+	 * and at the end that weren't touched */
+	bool dirty = false;
+	int dirty_n_items;
+	int dirty_head;
+	int dirty_tail;
+
+	static int transaction_depth = 0;
+	static List<BatchedMenu> dirty_menus = null;
+
+	/* Starts holding back changes, transactions can be nested */
+	public static void begin () {
+		transaction_depth++;
+	}
+
+	/* Ends the transaction started by the matching begin(), and emits the
+	 * collected changes if it was the outermost one */
+	public static void commit () {
+		return_if_fail (transaction_depth > 0);
+
+		if (--transaction_depth > 0)
+			return;
+
+		var menus = (owned) dirty_menus;
+		dirty_menus = null;
+
+		foreach (var menu in menus)
+			menu.flush ();
+	}
+
+	void flush () {
+		if (!this.dirty)
+			return;
+
+		this.dirty = false;
+
+		int n_items = this.items.get_n_items ();
+		for (int i = 0; i < n_items; i++) {
+			var iter = this.items.iterate_item_links (i);
+			string name;
+			MenuModel link;
+			while (iter.get_next (out name, out link)) {
+				var child = link as BatchedMenu;
+				if (child != null)
+					child.flush ();
+			}
+		}
+
+		int removed = this.dirty_n_items - this.dirty_head - this.dirty_tail;
+		int added = n_items - this.dirty_head - this.dirty_tail;
+
+		if (removed > 0 || added > 0)
+			this.emit_items_changed (this.dirty_head, removed, added);
+	}
+
+	void emit_items_changed (int position, int removed, int added) {
+		IndicatorSound.DebugMetrics.increment ("batched-menu-emissions");
+		this.items_changed (position, removed, added);
+	}
+
+	/* Records a mutation at @position of a menu that had @n_items before it */
+	void changed (int n_items, int position, int removed, int added) {
+		IndicatorSound.DebugMetrics.increment ("batched-menu-mutations");
+
+		if (transaction_depth == 0) {
+			this.emit_items_changed (position, removed, added);
+			return;
+		}
+
+		if (!this.dirty) {
+			this.dirty = true;
+			this.dirty_n_items = n_items;
+			this.dirty_head = n_items;
+			this.dirty_tail = n_items;
+			dirty_menus.append (this);
+		}
+
+		this.dirty_head = int.min (this.dirty_head, position);
+		this.dirty_tail = int.min (this.dirty_tail, n_items - position - removed);
+	}
+
+	public override bool is_mutable () {
+		return true;
+	}
+
+	public override int get_n_items () {
+		return this.items.get_n_items ();
+	}
+
+	public override void get_item_attributes (int item_index, out HashTable<string, Variant>? attributes) {
+		attributes = new HashTable<string, Variant> (str_hash, str_equal);
+
+		var iter = this.items.iterate_item_attributes (item_index);
+		string name;
+		Variant value;
+		while (iter.get_next (out name, out value))
+			attributes.insert (name, value);
+	}
+
+	public override void get_item_links (int item_index, out HashTable<string, MenuModel>? links) {
+		links = new HashTable<string, MenuModel> (str_hash, str_equal);
+
+		var iter = this.items.iterate_item_links (item_index);
+		string name;
+		MenuModel value;
+		while (iter.get_next (out name, out value))
+			links.insert (name, value);
+	}
+
+	public void append (string? label, string? detailed_action) {
+		this.append_item (new MenuItem (label, detailed_action));
+	}
+
+	public void append_item (MenuItem item) {
+		this.insert_item (this.items.get_n_items (), item);
+	}
+
+	public void insert_item (int position, MenuItem item) {
+		int n_items = this.items.get_n_items ();
+		this.items.insert_item (position, item);
+		this.changed (n_items, position, 0, 1);
+	}
+
+	public void append_section (string? label, MenuModel section) {
+		this.append_item (new MenuItem.section (label, section));
+	}
+
+	public void insert_section (int position, string? label, MenuModel section) {
+		this.insert_item (position, new MenuItem.section (label, section));
+	}
+
+	public void append_submenu (string? label, MenuModel submenu) {
+		this.append_item (new MenuItem.submenu (label, submenu));
+	}
+
+	public void remove (int position) {
+		int n_items = this.items.get_n_items ();
+		this.items.remove (position);
+		this.changed (n_items, position, 1, 0);
+	}
+
+	/* Replaces the item at @position with @item, as a single change */
+	public void replace_item (int position, MenuItem item) {
+		int n_items = this.items.get_n_items ();
+		this.items.remove (position);
+		this.items.insert_item (position, item);
+		this.changed (n_items, position, 1, 1);
+	}
+}
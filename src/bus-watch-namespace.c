@@ -20,30 +20,53 @@
 #include <string.h>
 #include "bus-watch-namespace.h"
 
+typedef struct _NamespaceSubscription NamespaceSubscription;
+
+/* A NamespaceSubscription is shared by all watchers of the same namespace on
+ * the same bus. It owns the NameOwnerChanged subscription and the table of
+ * names that are currently on the bus, and fans changes out to its watchers.
+ * Names from ListNames are reported right away to watchers with
+ * BUS_WATCH_NAMESPACE_FLAGS_LAZY_OWNER, and to the others once their owner
+ * has been resolved, which only happens when there are such watchers.
+ */
+struct _NamespaceSubscription
+{
+  gint                      ref_count;
+  gchar                    *key;
+  gchar                    *name_space;
+  GList                    *watchers;
+
+  GDBusConnection          *connection;
+  GCancellable             *cancellable;
+  GHashTable               *names;  /* name -> owner, NULL if not known */
+  GHashTable               *resolving;  /* names with a GetNameOwner call in flight */
+  guint                     subscription_id;
+};
+
 typedef struct
 {
   guint                     id;
-  gchar                    *name_space;
+  NamespaceSubscription    *subscription;
+  BusWatchNamespaceFlags    flags;
   GBusNameAppearedCallback  appeared_handler;
   GBusNameVanishedCallback  vanished_handler;
   gpointer                  user_data;
   GDestroyNotify            user_data_destroy;
 
-  GDBusConnection          *connection;
-  GCancellable             *cancellable;
-  GHashTable               *names;
-  guint                     subscription_id;
+  GHashTable               *names;  /* names reported to this watcher */
+  guint                     replay_id;
 } NamespaceWatcher;
 
 typedef struct
 {
-  NamespaceWatcher *watcher;
-  gchar            *name;
+  NamespaceSubscription *subscription;
+  gchar                 *name;
 } GetNameOwnerData;
 
 /* Global Variables */
 static guint namespace_watcher_next_id;
 static GHashTable *namespace_watcher_watchers;
+static GHashTable *namespace_subscriptions;
 
 /* Prototypes */
 static void connection_closed (GDBusConnection *connection,
@@ -51,16 +74,97 @@ static void connection_closed (GDBusConnection *connection,
                                GError          *error,
                                gpointer         user_data);
 
+static NamespaceSubscription *
+namespace_subscription_ref (NamespaceSubscription *subscription)
+{
+  subscription->ref_count++;
+  return subscription;
+}
+
+static void
+namespace_subscription_unref (gpointer data)
+{
+  NamespaceSubscription *subscription = data;
+
+  if (--subscription->ref_count > 0)
+    return;
+
+  g_clear_object (&subscription->connection);
+  g_object_unref (subscription->cancellable);
+  g_hash_table_unref (subscription->names);
+  g_hash_table_unref (subscription->resolving);
+  g_free (subscription->name_space);
+  g_free (subscription->key);
+
+  g_slice_free (NamespaceSubscription, subscription);
+}
+
+/* Called when the last watcher is gone: stops all bus activity. The
+ * subscription itself is freed when the last pending call returns.
+ */
+static void
+namespace_subscription_shutdown (NamespaceSubscription *subscription)
+{
+  g_cancellable_cancel (subscription->cancellable);
+
+  if (subscription->subscription_id)
+    {
+      g_dbus_connection_signal_unsubscribe (subscription->connection, subscription->subscription_id);
+      subscription->subscription_id = 0;
+    }
+
+  if (subscription->connection)
+    g_signal_handlers_disconnect_by_func (subscription->connection, connection_closed, subscription);
+
+  if (namespace_subscriptions)
+    {
+      if (g_hash_table_lookup (namespace_subscriptions, subscription->key) == subscription)
+        g_hash_table_remove (namespace_subscriptions, subscription->key);
+      if (g_hash_table_size (namespace_subscriptions) == 0)
+        g_clear_pointer (&namespace_subscriptions, g_hash_table_destroy);
+    }
+}
+
+/* Returns the ids of all watchers of @subscription. Handlers may add or remove
+ * watchers, so fan-outs iterate over a copy and look every watcher up again.
+ */
+static GArray *
+namespace_subscription_get_watcher_ids (NamespaceSubscription *subscription)
+{
+  GArray *ids;
+  GList *it;
+
+  ids = g_array_new (FALSE, FALSE, sizeof (guint));
+  for (it = subscription->watchers; it; it = it->next)
+    g_array_append_val (ids, ((NamespaceWatcher *) it->data)->id);
+
+  return ids;
+}
+
+static NamespaceWatcher *
+namespace_watcher_lookup (guint id)
+{
+  if (namespace_watcher_watchers == NULL)
+    return NULL;
+
+  return g_hash_table_lookup (namespace_watcher_watchers, GUINT_TO_POINTER (id));
+}
+
 static void
-namespace_watcher_stop (gpointer data)
+namespace_watcher_stop (NamespaceWatcher *watcher)
 {
-  NamespaceWatcher *watcher = data;
+  NamespaceSubscription *subscription = watcher->subscription;
+
+  if (watcher->replay_id)
+    g_source_remove (watcher->replay_id);
 
-  g_cancellable_cancel (watcher->cancellable);
-  g_object_unref (watcher->cancellable);
+  g_hash_table_remove (namespace_watcher_watchers, GUINT_TO_POINTER (watcher->id));
+  if (g_hash_table_size (namespace_watcher_watchers) == 0)
+    g_clear_pointer (&namespace_watcher_watchers, g_hash_table_destroy);
 
-  if (watcher->subscription_id)
-    g_dbus_connection_signal_unsubscribe (watcher->connection, watcher->subscription_id);
+  subscription->watchers = g_list_remove (subscription->watchers, watcher);
+  if (subscription->watchers == NULL)
+    namespace_subscription_shutdown (subscription);
 
   if (watcher->vanished_handler)
     {
@@ -69,27 +173,33 @@ namespace_watcher_stop (gpointer data)
 
       g_hash_table_iter_init (&it, watcher->names);
       while (g_hash_table_iter_next (&it, (gpointer *) &name, NULL))
-        watcher->vanished_handler (watcher->connection, name, watcher->user_data);
+        watcher->vanished_handler (subscription->connection, name, watcher->user_data);
     }
 
   if (watcher->user_data_destroy)
     watcher->user_data_destroy (watcher->user_data);
 
-  if (watcher->connection)
-    {
-      g_signal_handlers_disconnect_by_func (watcher->connection, connection_closed, watcher);
-      g_object_unref (watcher->connection);
-    }
-
   g_hash_table_unref (watcher->names);
+  g_free (watcher);
 
-  g_hash_table_remove (namespace_watcher_watchers, GUINT_TO_POINTER (watcher->id));
-  if (g_hash_table_size (namespace_watcher_watchers) == 0)
-    g_clear_pointer (&namespace_watcher_watchers, g_hash_table_destroy);
+  namespace_subscription_unref (subscription);
+}
 
-  g_free (watcher->name_space);
+static void
+namespace_subscription_stop_watchers (NamespaceSubscription *subscription)
+{
+  GArray *ids;
+  guint i;
 
-  g_free (watcher);
+  ids = namespace_subscription_get_watcher_ids (subscription);
+  for (i = 0; i < ids->len; i++)
+    {
+      NamespaceWatcher *watcher = namespace_watcher_lookup (g_array_index (ids, guint, i));
+      if (watcher)
+        namespace_watcher_stop (watcher);
+    }
+
+  g_array_free (ids, TRUE);
 }
 
 static void
@@ -97,20 +207,23 @@ namespace_watcher_name_appeared (NamespaceWatcher *watcher,
                                  const gchar      *name,
                                  const gchar      *owner)
 {
-  /* There's a race between NameOwnerChanged signals arriving and the
-   * ListNames/GetNameOwner sequence returning, so this function might
-   * be called more than once for the same name. To ensure that
-   * appeared_handler is only called once for each name, it is only
-   * called when inserting the name into watcher->names (each name is
-   * only inserted once there).
+  /* A name can reach a watcher more than once, e.g. from the replay of a new
+   * watcher and from the subscription at the same time. To ensure that
+   * appeared_handler is only called once for each name, it is only called
+   * when inserting the name into watcher->names (each name is only inserted
+   * once there).
    */
   if (g_hash_table_contains (watcher->names, name))
     return;
 
+  /* watchers that want owners hear about the name once it's resolved */
+  if (owner == NULL && !(watcher->flags & BUS_WATCH_NAMESPACE_FLAGS_LAZY_OWNER))
+    return;
+
   g_hash_table_add (watcher->names, g_strdup (name));
 
   if (watcher->appeared_handler)
-    watcher->appeared_handler (watcher->connection, name, owner, watcher->user_data);
+    watcher->appeared_handler (watcher->subscription->connection, name, owner, watcher->user_data);
 }
 
 static void
@@ -118,7 +231,107 @@ namespace_watcher_name_vanished (NamespaceWatcher *watcher,
                                  const gchar      *name)
 {
   if (g_hash_table_remove (watcher->names, name) && watcher->vanished_handler)
-    watcher->vanished_handler (watcher->connection, name, watcher->user_data);
+    watcher->vanished_handler (watcher->subscription->connection, name, watcher->user_data);
+}
+
+static void
+namespace_subscription_name_appeared (NamespaceSubscription *subscription,
+                                      const gchar           *name,
+                                      const gchar           *owner)
+{
+  GArray *ids;
+  guint i;
+  const gchar *known_owner;
+
+  /* There's a race between NameOwnerChanged signals arriving and the
+   * ListNames/GetNameOwner sequence returning, so this function might
+   * be called more than once for the same name. Only a name that is new,
+   * or an owner that wasn't known yet, needs to be reported.
+   */
+  if (g_hash_table_lookup_extended (subscription->names, name, NULL, (gpointer *) &known_owner) &&
+      (owner == NULL || known_owner != NULL))
+    return;
+
+  g_hash_table_insert (subscription->names, g_strdup (name), g_strdup (owner));
+
+  namespace_subscription_ref (subscription);
+
+  ids = namespace_subscription_get_watcher_ids (subscription);
+  for (i = 0; i < ids->len; i++)
+    {
+      NamespaceWatcher *watcher = namespace_watcher_lookup (g_array_index (ids, guint, i));
+      if (watcher && watcher->subscription == subscription)
+        namespace_watcher_name_appeared (watcher, name, owner);
+    }
+
+  g_array_free (ids, TRUE);
+  namespace_subscription_unref (subscription);
+}
+
+static void
+namespace_subscription_name_vanished (NamespaceSubscription *subscription,
+                                      const gchar           *name)
+{
+  GArray *ids;
+  guint i;
+
+  if (!g_hash_table_remove (subscription->names, name))
+    return;
+
+  namespace_subscription_ref (subscription);
+
+  ids = namespace_subscription_get_watcher_ids (subscription);
+  for (i = 0; i < ids->len; i++)
+    {
+      NamespaceWatcher *watcher = namespace_watcher_lookup (g_array_index (ids, guint, i));
+      if (watcher && watcher->subscription == subscription)
+        namespace_watcher_name_vanished (watcher, name);
+    }
+
+  g_array_free (ids, TRUE);
+  namespace_subscription_unref (subscription);
+}
+
+/* Reports the names that were already known to the subscription when the
+ * watcher was added.
+ */
+static gboolean
+namespace_watcher_replay (gpointer user_data)
+{
+  guint id = GPOINTER_TO_UINT (user_data);
+  NamespaceWatcher *watcher;
+  GPtrArray *names;
+  GHashTableIter it;
+  const gchar *name;
+  guint i;
+
+  watcher = namespace_watcher_lookup (id);
+  if (watcher == NULL)
+    return G_SOURCE_REMOVE;
+
+  watcher->replay_id = 0;
+
+  names = g_ptr_array_new_with_free_func (g_free);
+  g_hash_table_iter_init (&it, watcher->subscription->names);
+  while (g_hash_table_iter_next (&it, (gpointer *) &name, NULL))
+    g_ptr_array_add (names, g_strdup (name));
+
+  for (i = 0; i < names->len; i++)
+    {
+      const gchar *owner;
+
+      /* the handler might have removed the watcher */
+      watcher = namespace_watcher_lookup (id);
+      if (watcher == NULL)
+        break;
+
+      if (g_hash_table_lookup_extended (watcher->subscription->names, names->pdata[i], NULL, (gpointer *) &owner))
+        namespace_watcher_name_appeared (watcher, names->pdata[i], owner);
+    }
+
+  g_ptr_array_unref (names);
+
+  return G_SOURCE_REMOVE;
 }
 
 static gboolean
@@ -149,18 +362,31 @@ name_owner_changed (GDBusConnection *connection,
                     GVariant        *parameters,
                     gpointer         user_data)
 {
-  NamespaceWatcher *watcher = user_data;
+  NamespaceSubscription *subscription = user_data;
   const gchar *name;
   const gchar *old_owner;
   const gchar *new_owner;
 
+  if (subscription->watchers == NULL)
+    return;
+
   g_variant_get (parameters, "(&s&s&s)", &name, &old_owner, &new_owner);
 
   if (old_owner[0] != '\0')
-    namespace_watcher_name_vanished (watcher, name);
+    namespace_subscription_name_vanished (subscription, name);
 
   if (new_owner[0] != '\0')
-    namespace_watcher_name_appeared (watcher, name, new_owner);
+    namespace_subscription_name_appeared (subscription, name, new_owner);
+}
+
+static void
+get_name_owner_data_free (gpointer user_data)
+{
+  GetNameOwnerData *data = user_data;
+
+  namespace_subscription_unref (data->subscription);
+  g_free (data->name);
+  g_slice_free (GetNameOwnerData, data);
 }
 
 static void
@@ -189,14 +415,65 @@ got_name_owner (GObject      *object,
       goto out;
     }
 
+  /* the name might have vanished while the call was in flight */
   g_variant_get (reply, "(&s)", &owner);
-  namespace_watcher_name_appeared (data->watcher, data->name, owner);
+  if (g_hash_table_contains (data->subscription->names, data->name))
+    namespace_subscription_name_appeared (data->subscription, data->name, owner);
 
   g_variant_unref (reply);
 
 out:
-  g_free (data->name);
-  g_slice_free (GetNameOwnerData, data);
+  g_hash_table_remove (data->subscription->resolving, data->name);
+  get_name_owner_data_free (data);
+}
+
+static gboolean
+namespace_subscription_wants_owners (NamespaceSubscription *subscription)
+{
+  GList *it;
+
+  for (it = subscription->watchers; it; it = it->next)
+    {
+      NamespaceWatcher *watcher = it->data;
+      if (!(watcher->flags & BUS_WATCH_NAMESPACE_FLAGS_LAZY_OWNER))
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+/* Asks for the owners of all listed names that aren't known yet, if any
+ * watcher needs them. The calls are pipelined, not waited for one by one.
+ */
+static void
+namespace_subscription_resolve_owners (NamespaceSubscription *subscription)
+{
+  GHashTableIter it;
+  const gchar *name;
+  const gchar *owner;
+
+  if (subscription->connection == NULL || !namespace_subscription_wants_owners (subscription))
+    return;
+
+  g_hash_table_iter_init (&it, subscription->names);
+  while (g_hash_table_iter_next (&it, (gpointer *) &name, (gpointer *) &owner))
+    {
+      GetNameOwnerData *data;
+
+      if (owner != NULL || g_hash_table_contains (subscription->resolving, name))
+        continue;
+
+      g_hash_table_add (subscription->resolving, g_strdup (name));
+
+      data = g_slice_new (GetNameOwnerData);
+      data->subscription = namespace_subscription_ref (subscription);
+      data->name = g_strdup (name);
+      g_dbus_connection_call (subscription->connection, "org.freedesktop.DBus", "/",
+                              "org.freedesktop.DBus", "GetNameOwner",
+                              g_variant_new ("(s)", name), G_VARIANT_TYPE ("(s)"),
+                              G_DBUS_CALL_FLAGS_NONE, -1, subscription->cancellable,
+                              got_name_owner, data);
+    }
 }
 
 static void
@@ -204,7 +481,7 @@ names_listed (GObject      *object,
               GAsyncResult *result,
               gpointer      user_data)
 {
-  NamespaceWatcher *watcher;
+  NamespaceSubscription *subscription = user_data;
   GError *error = NULL;
   GVariant *reply;
   GVariantIter *iter;
@@ -215,36 +492,39 @@ names_listed (GObject      *object,
   if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
     {
       g_error_free (error);
-      return;
+      goto out;
     }
 
-  watcher = user_data;
-
   if (reply == NULL)
     {
       g_warning ("bus_watch_namespace: error calling org.freedesktop.DBus.ListNames: %s", error->message);
       g_error_free (error);
-      return;
+      goto out;
     }
 
   g_variant_get (reply, "(as)", &iter);
   while (g_variant_iter_next (iter, "&s", &name))
     {
-      if (dbus_name_has_namespace (name, watcher->name_space))
-        {
-          GetNameOwnerData *data = g_slice_new (GetNameOwnerData);
-          data->watcher = watcher;
-          data->name = g_strdup (name);
-          g_dbus_connection_call (watcher->connection, "org.freedesktop.DBus", "/",
-                                  "org.freedesktop.DBus", "GetNameOwner",
-                                  g_variant_new ("(s)", name), G_VARIANT_TYPE ("(s)"),
-                                  G_DBUS_CALL_FLAGS_NONE, -1, watcher->cancellable,
-                                  got_name_owner, data);
-        }
+      if (!dbus_name_has_namespace (name, subscription->name_space))
+        continue;
+
+      /* Names can't change owners without a NameOwnerChanged signal, which would
+       * arrive after this reply. So the names are reported to the watchers that
+       * don't need owners right away, and the owners are resolved afterwards. */
+      namespace_subscription_name_appeared (subscription, name, NULL);
+
+      /* the handlers might have removed all watchers */
+      if (subscription->watchers == NULL)
+        break;
     }
 
+  namespace_subscription_resolve_owners (subscription);
+
   g_variant_iter_free (iter);
   g_variant_unref (reply);
+
+out:
+  namespace_subscription_unref (subscription);
 }
 
 static void
@@ -253,9 +533,11 @@ connection_closed (GDBusConnection *connection,
                    GError          *error,
                    gpointer         user_data)
 {
-  NamespaceWatcher *watcher = user_data;
+  NamespaceSubscription *subscription = user_data;
 
-  namespace_watcher_stop (watcher);
+  namespace_subscription_ref (subscription);
+  namespace_subscription_stop_watchers (subscription);
+  namespace_subscription_unref (subscription);
 }
 
 static void
@@ -263,8 +545,8 @@ got_bus (GObject      *object,
          GAsyncResult *result,
          gpointer      user_data)
 {
+  NamespaceSubscription *subscription = user_data;
   GDBusConnection *connection;
-  NamespaceWatcher *watcher;
   GError *error = NULL;
 
   connection = g_bus_get_finish (result, &error);
@@ -272,30 +554,67 @@ got_bus (GObject      *object,
   if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
     {
       g_error_free (error);
-      return;
+      goto out;
     }
 
-  watcher = user_data;
-
   if (connection == NULL)
     {
-      namespace_watcher_stop (watcher);
-      return;
+      g_clear_error (&error);
+      namespace_subscription_stop_watchers (subscription);
+      goto out;
     }
 
-  watcher->connection = connection;
-  g_signal_connect (watcher->connection, "closed", G_CALLBACK (connection_closed), watcher);
+  subscription->connection = connection;
+  g_signal_connect (subscription->connection, "closed", G_CALLBACK (connection_closed), subscription);
 
-  watcher->subscription_id =
-    g_dbus_connection_signal_subscribe (watcher->connection, "org.freedesktop.DBus",
+  subscription->subscription_id =
+    g_dbus_connection_signal_subscribe (subscription->connection, "org.freedesktop.DBus",
                                         "org.freedesktop.DBus", "NameOwnerChanged", "/org/freedesktop/DBus",
-                                        watcher->name_space, G_DBUS_SIGNAL_FLAGS_MATCH_ARG0_NAMESPACE,
-                                        name_owner_changed, watcher, NULL);
+                                        subscription->name_space, G_DBUS_SIGNAL_FLAGS_MATCH_ARG0_NAMESPACE,
+                                        name_owner_changed, namespace_subscription_ref (subscription),
+                                        namespace_subscription_unref);
 
-  g_dbus_connection_call (watcher->connection, "org.freedesktop.DBus", "/",
+  g_dbus_connection_call (subscription->connection, "org.freedesktop.DBus", "/",
                           "org.freedesktop.DBus", "ListNames", NULL, G_VARIANT_TYPE ("(as)"),
-                          G_DBUS_CALL_FLAGS_NONE, -1, watcher->cancellable,
-                          names_listed, watcher);
+                          G_DBUS_CALL_FLAGS_NONE, -1, subscription->cancellable,
+                          names_listed, namespace_subscription_ref (subscription));
+
+out:
+  namespace_subscription_unref (subscription);
+}
+
+static NamespaceSubscription *
+namespace_subscription_get (GBusType     bus_type,
+                            const gchar *name_space)
+{
+  NamespaceSubscription *subscription;
+  gchar *key;
+
+  key = g_strdup_printf ("%d:%s", bus_type, name_space);
+
+  if (namespace_subscriptions == NULL)
+    namespace_subscriptions = g_hash_table_new (g_str_hash, g_str_equal);
+
+  subscription = g_hash_table_lookup (namespace_subscriptions, key);
+  if (subscription)
+    {
+      g_free (key);
+      return namespace_subscription_ref (subscription);
+    }
+
+  subscription = g_slice_new0 (NamespaceSubscription);
+  subscription->ref_count = 1;
+  subscription->key = key;
+  subscription->name_space = g_strdup (name_space);
+  subscription->cancellable = g_cancellable_new ();
+  subscription->names = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+  subscription->resolving = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+  g_hash_table_insert (namespace_subscriptions, subscription->key, subscription);
+
+  g_bus_get (bus_type, subscription->cancellable, got_bus, namespace_subscription_ref (subscription));
+
+  return subscription;
 }
 
 guint
@@ -305,6 +624,20 @@ bus_watch_namespace (GBusType                  bus_type,
                      GBusNameVanishedCallback  vanished_handler,
                      gpointer                  user_data,
                      GDestroyNotify            user_data_destroy)
+{
+  return bus_watch_namespace_with_flags (bus_type, name_space, BUS_WATCH_NAMESPACE_FLAGS_NONE,
+                                         appeared_handler, vanished_handler,
+                                         user_data, user_data_destroy);
+}
+
+guint
+bus_watch_namespace_with_flags (GBusType                  bus_type,
+                                const gchar              *name_space,
+                                BusWatchNamespaceFlags    flags,
+                                GBusNameAppearedCallback  appeared_handler,
+                                GBusNameVanishedCallback  vanished_handler,
+                                gpointer                  user_data,
+                                GDestroyNotify            user_data_destroy)
 {
   NamespaceWatcher *watcher;
 
@@ -313,20 +646,29 @@ bus_watch_namespace (GBusType                  bus_type,
   g_return_val_if_fail (appeared_handler || vanished_handler, 0);
 
   watcher = g_new0 (NamespaceWatcher, 1);
-  watcher->id = namespace_watcher_next_id++;
-  watcher->name_space = g_strdup (name_space);
+  /* 0 is never a valid id */
+  watcher->id = ++namespace_watcher_next_id;
+  watcher->flags = flags;
   watcher->appeared_handler = appeared_handler;
   watcher->vanished_handler = vanished_handler;
   watcher->user_data = user_data;
   watcher->user_data_destroy = user_data_destroy;
-  watcher->cancellable = g_cancellable_new ();
   watcher->names = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
 
   if (namespace_watcher_watchers == NULL)
     namespace_watcher_watchers = g_hash_table_new (g_direct_hash, g_direct_equal);
   g_hash_table_insert (namespace_watcher_watchers, GUINT_TO_POINTER (watcher->id), watcher);
 
-  g_bus_get (bus_type, watcher->cancellable, got_bus, watcher);
+  /* the reference is owned by the watcher */
+  watcher->subscription = namespace_subscription_get (bus_type, name_space);
+  watcher->subscription->watchers = g_list_append (watcher->subscription->watchers, watcher);
+
+  /* names that were listed for lazy watchers only still lack their owners */
+  namespace_subscription_resolve_owners (watcher->subscription);
+
+  /* names are always reported from the main loop, also when they are known already */
+  if (g_hash_table_size (watcher->subscription->names) > 0)
+    watcher->replay_id = g_idle_add (namespace_watcher_replay, GUINT_TO_POINTER (watcher->id));
 
   return watcher->id;
 }
@@ -339,17 +681,101 @@ bus_unwatch_namespace (guint id)
    * doesn't warn when @id is absent from the hash table.
    */
 
-  if (namespace_watcher_watchers)
+  NamespaceWatcher *watcher;
+
+  watcher = namespace_watcher_lookup (id);
+  if (watcher)
     {
-      NamespaceWatcher *watcher;
+      /* make sure vanished() is not called as a result of this function */
+      g_hash_table_remove_all (watcher->names);
 
-      watcher = g_hash_table_lookup (namespace_watcher_watchers, GUINT_TO_POINTER (id));
-      if (watcher)
-        {
-          /* make sure vanished() is not called as a result of this function */
-          g_hash_table_remove_all (watcher->names);
+      namespace_watcher_stop (watcher);
+    }
+}
+
+static void
+got_lazy_name_owner (GObject      *object,
+                     GAsyncResult *result,
+                     gpointer      user_data)
+{
+  GTask *task = user_data;
+  GetNameOwnerData *data = g_task_get_task_data (task);
+  GError *error = NULL;
+  GVariant *reply;
+  const gchar *owner;
+
+  reply = g_dbus_connection_call_finish (G_DBUS_CONNECTION (object), result, &error);
 
-          namespace_watcher_stop (watcher);
-        }
+  if (reply == NULL)
+    {
+      g_task_return_error (task, error);
+      g_object_unref (task);
+      return;
     }
+
+  g_variant_get (reply, "(&s)", &owner);
+
+  /* remember it for the next caller, and tell the watchers that were waiting
+   * for it, unless the name vanished in the meantime */
+  if (g_hash_table_contains (data->subscription->names, data->name))
+    namespace_subscription_name_appeared (data->subscription, data->name, owner);
+
+  g_task_return_pointer (task, g_strdup (owner), g_free);
+
+  g_variant_unref (reply);
+  g_object_unref (task);
+}
+
+void
+bus_watch_namespace_get_name_owner (guint                id,
+                                    const gchar         *name,
+                                    GCancellable        *cancellable,
+                                    GAsyncReadyCallback  callback,
+                                    gpointer             user_data)
+{
+  NamespaceWatcher *watcher;
+  GetNameOwnerData *data;
+  const gchar *owner;
+  GTask *task;
+
+  g_return_if_fail (name != NULL);
+
+  task = g_task_new (NULL, cancellable, callback, user_data);
+
+  watcher = namespace_watcher_lookup (id);
+  if (watcher == NULL || !g_hash_table_contains (watcher->names, name))
+    {
+      g_task_return_new_error (task, G_DBUS_ERROR, G_DBUS_ERROR_NAME_HAS_NO_OWNER,
+                               "'%s' has not been reported to watcher %u", name, id);
+      g_object_unref (task);
+      return;
+    }
+
+  owner = g_hash_table_lookup (watcher->subscription->names, name);
+  if (owner)
+    {
+      g_task_return_pointer (task, g_strdup (owner), g_free);
+      g_object_unref (task);
+      return;
+    }
+
+  data = g_slice_new (GetNameOwnerData);
+  data->subscription = namespace_subscription_ref (watcher->subscription);
+  data->name = g_strdup (name);
+  g_task_set_task_data (task, data, get_name_owner_data_free);
+
+  g_dbus_connection_call (watcher->subscription->connection, "org.freedesktop.DBus", "/",
+                          "org.freedesktop.DBus", "GetNameOwner",
+                          g_variant_new ("(s)", name), G_VARIANT_TYPE ("(s)"),
+                          G_DBUS_CALL_FLAGS_NONE, -1, cancellable,
+                          got_lazy_name_owner, task);
+}
+
+gchar *
+bus_watch_namespace_get_name_owner_finish (GAsyncResult  *result,
+                                           GError       **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, NULL), NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
 }
@@ -21,6 +21,21 @@
 
 #include <gio/gio.h>
 
+/**
+ * BusWatchNamespaceFlags:
+ * @BUS_WATCH_NAMESPACE_FLAGS_NONE: no flags
+ * @BUS_WATCH_NAMESPACE_FLAGS_LAZY_OWNER: report names that are already on the
+ *   bus as soon as ListNames returns, without asking for their owners. The
+ *   appeared handler is called with a %NULL owner for those names; use
+ *   bus_watch_namespace_get_name_owner() to resolve one when it is needed.
+ *   Names that appear later are reported with their owner.
+ */
+typedef enum
+{
+  BUS_WATCH_NAMESPACE_FLAGS_NONE       = 0,
+  BUS_WATCH_NAMESPACE_FLAGS_LAZY_OWNER = (1 << 0)
+} BusWatchNamespaceFlags;
+
 guint       bus_watch_namespace         (GBusType                  bus_type,
                                          const gchar              *name_space,
                                          GBusNameAppearedCallback  appeared_handler,
@@ -28,6 +43,23 @@ guint       bus_watch_namespace         (GBusType                  bus_type,
                                          gpointer                  user_data,
                                          GDestroyNotify            user_data_destroy);
 
+guint       bus_watch_namespace_with_flags (GBusType                  bus_type,
+                                            const gchar              *name_space,
+                                            BusWatchNamespaceFlags    flags,
+                                            GBusNameAppearedCallback  appeared_handler,
+                                            GBusNameVanishedCallback  vanished_handler,
+                                            gpointer                  user_data,
+                                            GDestroyNotify            user_data_destroy);
+
 void        bus_unwatch_namespace       (guint id);
 
+void        bus_watch_namespace_get_name_owner        (guint                id,
+                                                       const gchar         *name,
+                                                       GCancellable        *cancellable,
+                                                       GAsyncReadyCallback  callback,
+                                                       gpointer             user_data);
+
+gchar *     bus_watch_namespace_get_name_owner_finish (GAsyncResult        *result,
+                                                       GError             **error);
+
 #endif
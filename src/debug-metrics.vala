@@ -0,0 +1,72 @@
+/*
+ * Copyright 2016 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Process-wide named counters and gauges describing how much work the service
+ * does (or avoids doing).  They are meant for debugging and load testing only.
+ */
+public class IndicatorSound.DebugMetrics : Object {
+
+	[Compact]
+	class Metric {
+		public int64 value = 0;
+	}
+
+	static HashTable<string, Metric> metrics = null;
+
+	static unowned Metric lookup (string name) {
+		if (metrics == null)
+			metrics = new HashTable<string, Metric> (str_hash, str_equal);
+
+		unowned Metric? metric = metrics.lookup (name);
+		if (metric == null) {
+			var new_metric = new Metric ();
+			metric = new_metric;
+			metrics.insert (name, (owned) new_metric);
+		}
+
+		return metric;
+	}
+
+	/** Adds @delta to the counter called @name */
+	public static void increment (string name, int64 delta = 1) {
+		lookup (name).value += delta;
+	}
+
+	/** Sets the gauge called @name to @value */
+	public static void set_value (string name, int64 value) {
+		lookup (name).value = value;
+	}
+
+	/** Returns the current value of @name, or 0 if it was never set */
+	public static int64 get_value (string name) {
+		if (metrics == null)
+			return 0;
+
+		unowned Metric? metric = metrics.lookup (name);
+		return metric != null ? metric.value : 0;
+	}
+
+	/** Logs all metrics with debug() */
+	public static void dump () {
+		if (metrics == null)
+			return;
+
+		metrics.@foreach ((name, metric) => {
+			debug ("metric %s: %" + int64.FORMAT, name, metric.value);
+		});
+	}
+}
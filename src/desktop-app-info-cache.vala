@@ -0,0 +1,50 @@
+/*
+ * Copyright 2016 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * DesktopAppInfoCache remembers the result of looking up desktop entries by id,
+ * including ids that don't have a desktop entry.  The cache is filled lazily and
+ * dropped whenever the set of installed applications changes.
+ */
+public class DesktopAppInfoCache : Object {
+
+	static HashTable<string, DesktopAppInfo?> entries = null;
+	static AppInfoMonitor monitor = null;
+
+	/**
+	 * Returns the application with the desktop file id @desktop_id, or null if there
+	 * is no such application.  Must be called from the main thread.
+	 */
+	public static DesktopAppInfo? lookup (string desktop_id) {
+		if (entries == null) {
+			entries = new HashTable<string, DesktopAppInfo?> (str_hash, str_equal);
+
+			monitor = AppInfoMonitor.get ();
+			monitor.changed.connect (() => {
+				debug ("installed applications changed, clearing desktop entry cache");
+				entries.remove_all ();
+			});
+		}
+
+		/* null values are negative entries */
+		if (entries.contains (desktop_id))
+			return entries.lookup (desktop_id);
+
+		var appinfo = new DesktopAppInfo (desktop_id);
+		entries.insert (desktop_id, appinfo);
+		return appinfo;
+	}
+}
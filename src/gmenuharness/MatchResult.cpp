@@ -18,8 +18,7 @@
 
 #include <unity/gmenuharness/MatchResult.h>
 
-#include <chrono>
-#include <map>
+#include <algorithm>
 #include <sstream>
 #include <iostream>
 
@@ -34,15 +33,16 @@ namespace gmenuharness
 namespace
 {
 
+static const chrono::seconds DEFAULT_TIMEOUT(10);
 
-static void printLocation(ostream& ss, const vector<unsigned int>& location, bool first)
+static void printLocation(ostream& ss, const unsigned int* location, size_t length, bool first)
 {
-    for (int i : location)
+    for (size_t i = 0; i < length; ++i)
     {
         ss << " ";
         if (first)
         {
-            ss << i;
+            ss << location[i];
         }
         else
         {
@@ -51,55 +51,46 @@ static void printLocation(ostream& ss, const vector<unsigned int>& location, boo
     }
     ss << " ";
 }
+}
 
-struct compare_vector
+struct MatchResult::Priv
 {
-    bool operator()(const vector<unsigned int>& a,
-               const vector<unsigned int>& b) const
+    struct Failure
     {
-        auto p1 = a.begin();
-        auto p2 = b.begin();
+        /* The failure's location is m_locations[offset, offset + length) */
+        size_t offset;
 
-        while (p1 != a.end())
-        {
-            if (p2 == b.end())
-            {
-                return false;
-            }
-            if (*p2 > *p1)
-            {
-                return true;
-            }
-            if (*p1 > *p2)
-            {
-                return false;
-            }
-
-            ++p1;
-            ++p2;
-        }
+        size_t length;
 
-        if (p2 != b.end())
-        {
-            return true;
-        }
+        string message;
+    };
 
-        return false;
-    }
-};
-}
+    /* The locations of all failures, one after the other */
+    vector<unsigned int> m_locations;
 
-struct MatchResult::Priv
-{
-    bool m_success = true;
+    vector<Failure> m_failures;
 
-    map<vector<unsigned int>, vector<string>, compare_vector> m_failures;
+    void add(const unsigned int* location, size_t length, const string& message)
+    {
+        m_failures.push_back(Failure{m_locations.size(), length, message});
+        m_locations.insert(m_locations.end(), location, location + length);
+    }
 
-    chrono::time_point<chrono::system_clock> m_timeout = chrono::system_clock::now() + chrono::seconds(10);
+    bool less(const Failure& a, const Failure& b) const
+    {
+        auto locationA = m_locations.data() + a.offset;
+        auto locationB = m_locations.data() + b.offset;
+        return lexicographical_compare(locationA, locationA + a.length, locationB, locationB + b.length);
+    }
+
+    bool equal(const Failure& a, const Failure& b) const
+    {
+        return !less(a, b) && !less(b, a);
+    }
 };
 
 MatchResult::MatchResult() :
-        p(new Priv)
+        m_deadline(chrono::steady_clock::now() + DEFAULT_TIMEOUT)
 {
 }
 
@@ -108,21 +99,23 @@ MatchResult::MatchResult(MatchResult&& other)
     *this = move(other);
 }
 
-MatchResult::MatchResult(const MatchResult& other) :
-        p(new Priv)
+MatchResult::MatchResult(const MatchResult& other)
 {
     *this = other;
 }
 
 MatchResult& MatchResult::operator=(const MatchResult& other)
 {
-    p->m_success = other.p->m_success;
-    p->m_failures= other.p->m_failures;
+    m_success = other.m_success;
+    m_deadline = other.m_deadline;
+    p = other.p ? make_shared<Priv>(*other.p) : nullptr;
     return *this;
 }
 
 MatchResult& MatchResult::operator=(MatchResult&& other)
 {
+    m_success = other.m_success;
+    m_deadline = other.m_deadline;
     p = move(other.p);
     return *this;
 }
@@ -130,54 +123,86 @@ MatchResult& MatchResult::operator=(MatchResult&& other)
 MatchResult MatchResult::createChild() const
 {
     MatchResult child;
-    child.p->m_timeout = p->m_timeout;
+    child.m_deadline = m_deadline;
     return child;
 }
 
 void MatchResult::failure(const vector<unsigned int>& location, const string& message)
 {
-    p->m_success = false;
-    auto it = p->m_failures.find(location);
-    if (it == p->m_failures.end())
+    m_success = false;
+    if (!p)
     {
-        it = p->m_failures.insert(make_pair(location, vector<string>())).first;
+        p = make_shared<Priv>();
     }
-    it->second.emplace_back(message);
+    p->add(location.data(), location.size(), message);
+}
+
+void MatchResult::failure(const vector<unsigned int>& parentLocation, unsigned int index, const string& message)
+{
+    m_success = false;
+    if (!p)
+    {
+        p = make_shared<Priv>();
+    }
+    p->add(parentLocation.data(), parentLocation.size(), message);
+    p->m_locations.push_back(index);
+    p->m_failures.back().length++;
 }
 
 void MatchResult::merge(const MatchResult& other)
 {
-    p->m_success &= other.p->m_success;
-    for (const auto& e : other.p->m_failures)
+    m_success &= other.m_success;
+    if (!other.p)
+    {
+        return;
+    }
+
+    if (!p)
+    {
+        p = make_shared<Priv>();
+    }
+    for (const auto& failure : other.p->m_failures)
     {
-        p->m_failures.insert(make_pair(e.first, e.second));
+        p->add(other.p->m_locations.data() + failure.offset, failure.length, failure.message);
     }
 }
 
 bool MatchResult::success() const
 {
-    return p->m_success;
+    return m_success;
 }
 
 bool MatchResult::hasTimedOut() const
 {
-    auto now = chrono::system_clock::now();
-    return (now >= p->m_timeout);
+    return chrono::steady_clock::now() >= m_deadline;
 }
 
 string MatchResult::concat_failures() const
 {
     stringstream ss;
     ss << "Failed expectations:" << endl;
+    if (!p)
+    {
+        return ss.str();
+    }
+
+    /* Failures are listed by location, the location is only printed for the first one */
+    vector<const Priv::Failure*> failures;
     for (const auto& failure : p->m_failures)
     {
-        bool first = true;
-        for (const string& s: failure.second)
-        {
-            printLocation(ss, failure.first, first);
-            first = false;
-            ss << s << endl;
-        }
+        failures.push_back(&failure);
+    }
+    stable_sort(failures.begin(), failures.end(),
+                [this](const Priv::Failure* a, const Priv::Failure* b)
+                {
+                    return p->less(*a, *b);
+                });
+
+    for (size_t i = 0; i < failures.size(); ++i)
+    {
+        bool first = i == 0 || !p->equal(*failures[i - 1], *failures[i]);
+        printLocation(ss, p->m_locations.data() + failures[i]->offset, failures[i]->length, first);
+        ss << failures[i]->message << endl;
     }
     return ss.str();
 }
@@ -20,6 +20,8 @@
 
 #include <unity/util/ResourcePtr.h>
 
+#include <map>
+
 using namespace std;
 namespace util = unity::util;
 
@@ -29,6 +31,138 @@ namespace unity
 namespace gmenuharness
 {
 
+namespace
+{
+
+class ActionStateSnapshot
+{
+public:
+    /* The snapshot is owned by the action group, its signal handlers go away with it */
+    ActionStateSnapshot(GActionGroup* actionGroup) :
+            m_actionGroup(actionGroup)
+    {
+        g_signal_connect(actionGroup, "action-added", G_CALLBACK(&ActionStateSnapshot::added), this);
+        g_signal_connect(actionGroup, "action-removed", G_CALLBACK(&ActionStateSnapshot::removed), this);
+        g_signal_connect(actionGroup, "action-state-changed", G_CALLBACK(&ActionStateSnapshot::stateChanged), this);
+
+        gchar** names = g_action_group_list_actions(actionGroup);
+        for (gchar** name = names; *name; ++name)
+        {
+            refresh(*name);
+        }
+        g_strfreev(names);
+    }
+
+    shared_ptr<GVariant> get(const string& action) const
+    {
+        auto it = m_states.find(action);
+        return it != m_states.end() ? it->second : nullptr;
+    }
+
+    static void destroy(gpointer snapshot)
+    {
+        delete static_cast<ActionStateSnapshot*>(snapshot);
+    }
+
+protected:
+    void refresh(const gchar* action)
+    {
+        GVariant* state = g_action_group_get_action_state(m_actionGroup, action);
+        if (state)
+        {
+            m_states[action] = shared_ptr<GVariant>(state, &gvariant_deleter);
+        }
+        else
+        {
+            m_states.erase(action);
+        }
+    }
+
+    static void added(GActionGroup*, const gchar* action, gpointer snapshot)
+    {
+        static_cast<ActionStateSnapshot*>(snapshot)->refresh(action);
+    }
+
+    static void removed(GActionGroup*, const gchar* action, gpointer snapshot)
+    {
+        static_cast<ActionStateSnapshot*>(snapshot)->m_states.erase(action);
+    }
+
+    static void stateChanged(GActionGroup*, const gchar* action, GVariant* state, gpointer snapshot)
+    {
+        static_cast<ActionStateSnapshot*>(snapshot)->m_states[action] =
+                shared_ptr<GVariant>(g_variant_ref(state), &gvariant_deleter);
+    }
+
+    GActionGroup* m_actionGroup;
+
+    map<string, shared_ptr<GVariant>> m_states;
+};
+
+static const gchar* ACTION_STATE_SNAPSHOT_KEY = "gmenuharness-action-state-snapshot";
+
+static ActionRecorder* currentRecorder = nullptr;
+}
+
+ActionRecorder::ActionRecorder() :
+        m_previous(currentRecorder)
+{
+    currentRecorder = this;
+}
+
+ActionRecorder::~ActionRecorder()
+{
+    currentRecorder = m_previous;
+}
+
+const set<ActionRecorder::Action>& ActionRecorder::read() const
+{
+    return m_read;
+}
+
+const set<ActionRecorder::Action>& ActionRecorder::changed() const
+{
+    return m_changed;
+}
+
+void ActionRecorder::recordRead(GActionGroup* actionGroup, const string& action)
+{
+    if (currentRecorder)
+    {
+        currentRecorder->m_read.emplace(actionGroup, action);
+    }
+}
+
+void ActionRecorder::recordChange(GActionGroup* actionGroup, const string& action)
+{
+    if (currentRecorder)
+    {
+        currentRecorder->m_changed.emplace(actionGroup, action);
+    }
+}
+
+shared_ptr<GVariant> actionGroupGetState(const shared_ptr<GActionGroup>& actionGroup, const string& action)
+{
+    /* a missing state counts too, the action may still be added */
+    ActionRecorder::recordRead(actionGroup.get(), action);
+
+    if (!actionGroup)
+    {
+        return nullptr;
+    }
+
+    auto snapshot = static_cast<ActionStateSnapshot*>(
+            g_object_get_data(G_OBJECT(actionGroup.get()), ACTION_STATE_SNAPSHOT_KEY));
+    if (!snapshot)
+    {
+        snapshot = new ActionStateSnapshot(actionGroup.get());
+        g_object_set_data_full(G_OBJECT(actionGroup.get()), ACTION_STATE_SNAPSHOT_KEY,
+                               snapshot, &ActionStateSnapshot::destroy);
+    }
+
+    return snapshot->get(action);
+}
+
 void waitForCore (GObject * obj, const string& signalName, unsigned int timeout) {
     shared_ptr<GMainLoop> loop(g_main_loop_new(nullptr, false), &g_main_loop_unref);
 
@@ -49,10 +49,7 @@ static string bool_to_string(bool value)
 
 static shared_ptr<GVariant> get_action_group_attribute(const shared_ptr<GActionGroup>& actionGroup, const gchar* attribute)
 {
-    shared_ptr<GVariant> value(
-            g_action_group_get_action_state(actionGroup.get(), attribute),
-            &gvariant_deleter);
-    return value;
+    return actionGroupGetState(actionGroup, attribute);
 }
 
 static shared_ptr<GVariant> get_attribute(const shared_ptr<GMenuItem> menuItem, const gchar* attribute)
@@ -477,9 +474,6 @@ void MenuItemMatcher::match(
 {
     shared_ptr<GMenuItem> menuItem(g_menu_item_new_from_model(menu.get(), index), &g_object_deleter);
 
-    vector<unsigned int> location(parentLocation);
-    location.emplace_back(index);
-
     string action = get_string_attribute(menuItem, G_MENU_ATTRIBUTE_ACTION);
 
     bool isCheckbox = false;
@@ -494,9 +488,7 @@ void MenuItemMatcher::match(
     {
         idPair = split_action(action);
         actionGroup = actions[idPair.first];
-        state = shared_ptr<GVariant>(g_action_group_get_action_state(actionGroup.get(),
-                                     idPair.second.c_str()),
-                                     &gvariant_deleter);
+        state = actionGroupGetState(actionGroup, idPair.second);
         auto attributeTarget = get_attribute(menuItem, G_MENU_ATTRIBUTE_TARGET);
 
         if (attributeTarget && state)
@@ -525,7 +517,7 @@ void MenuItemMatcher::match(
     if (actualType != p->m_type)
     {
         matchResult.failure(
-                location,
+                parentLocation, index,
                 "Expected " + type_to_string(p->m_type) + ", found "
                         + type_to_string(actualType));
     }
@@ -538,7 +530,7 @@ void MenuItemMatcher::match(
         if (!icon_val)
         {
             matchResult.failure(
-                            location,
+                            parentLocation, index,
                             "Expected themed icon " + (*(*iter).first) + " was not found");
         }
 
@@ -546,7 +538,7 @@ void MenuItemMatcher::match(
         if (!gicon || !G_IS_THEMED_ICON(gicon))
         {
             matchResult.failure(
-                           location,
+                           parentLocation, index,
                            "Expected attribute " + (*(*iter).first) + " is not a themed icon");
         }
         auto iconNames = g_themed_icon_get_names(G_THEMED_ICON(gicon));
@@ -559,7 +551,7 @@ void MenuItemMatcher::match(
         if (nb_icons != (*iter).second.size())
         {
             matchResult.failure(
-                       location,
+                       parentLocation, index,
                        "Expected " + to_string((*iter).second.size()) +
                        " icons for themed icon [" + (*(*iter).first) +
                        "], but " + to_string(nb_icons) + " were found.");
@@ -572,7 +564,7 @@ void MenuItemMatcher::match(
                 if (string(iconNames[i]) != (*iter).second[i])
                 {
                     matchResult.failure(
-                               location,
+                               parentLocation, index,
                                "Icon at position " + to_string(i) +
                                " for themed icon [" + (*(*iter).first) +
                                "], mismatchs. Expected: " + iconNames[i] + " but found " + (*iter).second[i]);
@@ -586,7 +578,7 @@ void MenuItemMatcher::match(
     if (p->m_label && (*p->m_label) != label)
     {
         matchResult.failure(
-                location,
+                parentLocation, index,
                 "Expected label '" + *p->m_label + "', but found '" + label
                         + "'");
     }
@@ -595,14 +587,14 @@ void MenuItemMatcher::match(
     if (p->m_icon && (*p->m_icon) != icon)
     {
         matchResult.failure(
-                location,
+                parentLocation, index,
                 "Expected icon '" + *p->m_icon + "', but found '" + icon + "'");
     }
 
     if (p->m_action && (*p->m_action) != action)
     {
         matchResult.failure(
-                location,
+                parentLocation, index,
                 "Expected action '" + *p->m_action + "', but found '" + action
                         + "'");
     }
@@ -610,14 +602,14 @@ void MenuItemMatcher::match(
     if (!p->m_state_icons.empty() && !state)
     {
         matchResult.failure(
-                location,
+                parentLocation, index,
                 "Expected state icons but no state was found");
     }
     else if (!p->m_state_icons.empty() && state &&
              !g_variant_is_of_type(state.get(), G_VARIANT_TYPE_VARDICT))
     {
         matchResult.failure(
-                location,
+                parentLocation, index,
                 "Expected state icons vardict, found "
                         + type_to_string(actualType));
     }
@@ -682,7 +674,7 @@ void MenuItemMatcher::match(
                 actual_icons += i == 0 ? actual_state_icons[i] : ", " + actual_state_icons[i];
             }
             matchResult.failure(
-                    location,
+                    parentLocation, index,
                     "Expected state_icons == {" + expected_icons
                         + "} but found {" + actual_icons + "}");
         }
@@ -694,7 +686,7 @@ void MenuItemMatcher::match(
         if (actionName.empty())
         {
             matchResult.failure(
-                    location,
+                    parentLocation, index,
                     "Could not find action name '" + e.first + "'");
         }
         else
@@ -708,7 +700,7 @@ void MenuItemMatcher::match(
                 if (!value)
                 {
                     matchResult.failure(
-                            location,
+                            parentLocation, index,
                             "Expected pass-through attribute '" + e.first
                                     + "' was not present");
                 }
@@ -717,7 +709,7 @@ void MenuItemMatcher::match(
                     std::string expectedType = g_variant_get_type_string(e.second.get());
                     std::string actualType = g_variant_get_type_string(value.get());
                     matchResult.failure(
-                            location,
+                            parentLocation, index,
                             "Expected pass-through attribute type '" + expectedType
                                     + "' but found '" + actualType + "'");
                 }
@@ -740,7 +732,7 @@ void MenuItemMatcher::match(
                         gchar* expectedString = g_variant_print(e.second.get(), true);
                         gchar* actualString = g_variant_print(value.get(), true);
                         matchResult.failure(
-                                location,
+                                parentLocation, index,
                                 "Expected pass-through attribute '" + e.first
                                     + "' == " + expectedString + " but found "
                                     + actualString);
@@ -752,7 +744,7 @@ void MenuItemMatcher::match(
             }
             else
             {
-                matchResult.failure(location, "Could not find action group for ID '" + passThroughIdPair.first + "'");
+                matchResult.failure(parentLocation, index, "Could not find action group for ID '" + passThroughIdPair.first + "'");
             }
         }
     }
@@ -762,7 +754,7 @@ void MenuItemMatcher::match(
         auto value = get_attribute(menuItem, e.first.c_str());
         if (!value)
         {
-            matchResult.failure(location,
+            matchResult.failure(parentLocation, index,
                     "Expected attribute '" + e.first
                             + "' could not be found");
         }
@@ -771,7 +763,7 @@ void MenuItemMatcher::match(
             std::string expectedType = g_variant_get_type_string(e.second.get());
             std::string actualType = g_variant_get_type_string(value.get());
             matchResult.failure(
-                    location,
+                    parentLocation, index,
                     "Expected attribute type '" + expectedType
                             + "' but found '" + actualType + "'");
         }
@@ -780,7 +772,7 @@ void MenuItemMatcher::match(
             gchar* expectedString = g_variant_print(e.second.get(), true);
             gchar* actualString = g_variant_print(value.get(), true);
             matchResult.failure(
-                    location,
+                    parentLocation, index,
                     "Expected attribute '" + e.first + "' == " + expectedString
                             + ", but found " + actualString);
             g_free(expectedString);
@@ -793,7 +785,7 @@ void MenuItemMatcher::match(
         auto value = get_attribute(menuItem, e.c_str());
         if (value)
         {
-            matchResult.failure(location,
+            matchResult.failure(parentLocation, index,
                     "Not expected attribute '" + e
                             + "' was found");
         }
@@ -802,7 +794,7 @@ void MenuItemMatcher::match(
     if (p->m_isToggled && (*p->m_isToggled) != isToggled)
     {
         matchResult.failure(
-                location,
+                parentLocation, index,
                 "Expected toggled = " + bool_to_string(*p->m_isToggled)
                         + ", but found " + bool_to_string(isToggled));
     }
@@ -845,14 +837,14 @@ void MenuItemMatcher::match(
             if (p->m_expectedSize)
             {
                 matchResult.failure(
-                        location,
+                        parentLocation, index,
                         "Expected " + to_string(*p->m_expectedSize)
                                 + " children, but found none");
             }
             else
             {
                 matchResult.failure(
-                        location,
+                        parentLocation, index,
                         "Expected " + to_string(p->m_items.size())
                                 + " children, but found none");
             }
@@ -860,6 +852,10 @@ void MenuItemMatcher::match(
         }
         else
         {
+            /* Only items with children need their location as a vector */
+            vector<unsigned int> location(parentLocation);
+            location.emplace_back(index);
+
             while (true)
             {
                 MatchResult childMatchResult(matchResult.createChild());
@@ -870,7 +866,7 @@ void MenuItemMatcher::match(
                                         link.get()))
                 {
                     childMatchResult.failure(
-                            location,
+                            parentLocation, index,
                             "Expected " + to_string(*p->m_expectedSize)
                                     + " child items, but found "
                                     + to_string(
@@ -927,25 +923,26 @@ void MenuItemMatcher::match(
         if (stateAction.empty())
         {
             matchResult.failure(
-                    location,
+                    parentLocation, index,
                     "Tried to set action state, but no action was found");
         }
         else if(!stateActionGroup)
         {
             matchResult.failure(
-                    location,
+                    parentLocation, index,
                     "Tried to set action state for action group '" + stateIdPair.first
                             + "', but action group wasn't found");
         }
         else if (!g_action_group_has_action(stateActionGroup.get(), stateIdPair.second.c_str()))
         {
             matchResult.failure(
-                    location,
+                    parentLocation, index,
                     "Tried to set action state for action '" + stateAction
                             + "', but action was not found");
         }
         else
         {
+            ActionRecorder::recordChange(stateActionGroup.get(), stateIdPair.second);
             g_action_group_change_action_state(stateActionGroup.get(), stateIdPair.second.c_str(),
                                                g_variant_ref(a.second.get()));
         }
@@ -969,24 +966,25 @@ void MenuItemMatcher::match(
         if (tmpAction.empty())
         {
             matchResult.failure(
-                    location,
+                    parentLocation, index,
                     "Tried to activate action, but no action was found");
         }
         else if(!tmpActionGroup)
         {
             matchResult.failure(
-                    location,
+                    parentLocation, index,
                     "Tried to activate action group '" + tmpIdPair.first
                             + "', but action group wasn't found");
         }
         else if (!g_action_group_has_action(tmpActionGroup.get(), tmpIdPair.second.c_str()))
         {
             matchResult.failure(
-                    location,
+                    parentLocation, index,
                     "Tried to activate action '" + tmpAction + "', but action was not found");
         }
         else
         {
+            ActionRecorder::recordChange(tmpActionGroup.get(), tmpIdPair.second);
             if (a.second)
             {
                 g_action_group_activate_action(tmpActionGroup.get(), tmpIdPair.second.c_str(),
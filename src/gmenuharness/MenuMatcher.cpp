@@ -20,6 +20,7 @@
 #include <unity/gmenuharness/MatchUtils.h>
 
 #include <iostream>
+#include <set>
 
 #include <gio/gio.h>
 
@@ -42,6 +43,180 @@ static void gdbus_connection_deleter(GDBusConnection* connection)
 //    }
     g_clear_object(&connection);
 }
+
+/**
+ * The state of one of the expected top level items across match passes.
+ * Once an item matched, the models of its subtree are watched, and it is
+ * only matched again after one of them, or one of the actions it read,
+ * changed.
+ */
+struct SubtreeState
+{
+    bool m_matched = false;
+
+    bool m_dirty = false;
+
+    bool m_matching = false;
+
+    /* the actions whose state the last match read */
+    set<ActionRecorder::Action> m_actions;
+
+    /* actions that changed while the item was being matched */
+    set<ActionRecorder::Action> m_changedWhileMatching;
+
+    vector<pair<shared_ptr<GMenuModel>, gulong>> m_watches;
+
+    ~SubtreeState()
+    {
+        unwatch();
+    }
+
+    static void changed(GMenuModel*, gint, gint, gint, gpointer user_data)
+    {
+        static_cast<SubtreeState*>(user_data)->m_dirty = true;
+    }
+
+    void watchModel(GMenuModel* model)
+    {
+        m_watches.emplace_back(
+                shared_ptr<GMenuModel>(G_MENU_MODEL(g_object_ref(model)), &g_object_deleter),
+                g_signal_connect(model, "items-changed", G_CALLBACK(&SubtreeState::changed), this));
+
+        int count = g_menu_model_get_n_items(model);
+        for (int i = 0; i < count; ++i)
+        {
+            watchLinks(model, i);
+        }
+    }
+
+    void watchLinks(GMenuModel* menu, int index)
+    {
+        GMenuLinkIter* iter = g_menu_model_iterate_item_links(menu, index);
+        GMenuModel* link = nullptr;
+        while (g_menu_link_iter_get_next(iter, nullptr, &link))
+        {
+            watchModel(link);
+            g_object_unref(link);
+        }
+        g_object_unref(iter);
+    }
+
+    void unwatch()
+    {
+        for (const auto& watch : m_watches)
+        {
+            g_signal_handler_disconnect(watch.first.get(), watch.second);
+        }
+        m_watches.clear();
+    }
+
+    void actionChanged(const ActionRecorder::Action& action)
+    {
+        if (m_matching)
+        {
+            m_changedWhileMatching.insert(action);
+        }
+        else if (m_actions.count(action))
+        {
+            m_dirty = true;
+        }
+    }
+
+    void beginMatch()
+    {
+        m_dirty = false;
+        m_matching = true;
+        m_changedWhileMatching.clear();
+    }
+
+    /*
+     * Changes that arrived while matching only count when they are not the
+     * item's own activations or state changes, otherwise the item would be
+     * matched (and activated) again on every pass.
+     */
+    void endMatch(const ActionRecorder& recorder)
+    {
+        m_matching = false;
+        m_actions = recorder.read();
+        for (const auto& action : m_changedWhileMatching)
+        {
+            if (m_actions.count(action) && !recorder.changed().count(action))
+            {
+                m_dirty = true;
+            }
+        }
+        m_changedWhileMatching.clear();
+    }
+};
+
+/*
+ * Marks the top level items that moved or changed as dirty, and those that
+ * read the state of an action that changed.  Enabled flags aren't matched, so
+ * their changes don't matter.
+ */
+struct TopLevelState
+{
+    vector<unique_ptr<SubtreeState>> m_subtrees;
+
+    vector<pair<shared_ptr<GActionGroup>, gulong>> m_actionWatches;
+
+    ~TopLevelState()
+    {
+        for (const auto& watch : m_actionWatches)
+        {
+            g_signal_handler_disconnect(watch.first.get(), watch.second);
+        }
+    }
+
+    static void changed(GMenuModel*, gint position, gint removed, gint added, gpointer user_data)
+    {
+        auto& subtrees = static_cast<TopLevelState*>(user_data)->m_subtrees;
+        size_t end = removed == added ? position + removed : subtrees.size();
+        for (size_t i = position; i < end && i < subtrees.size(); ++i)
+        {
+            subtrees[i]->m_dirty = true;
+        }
+    }
+
+    void actionChanged(GActionGroup* actionGroup, const gchar* name)
+    {
+        ActionRecorder::Action action(actionGroup, name);
+        for (const auto& subtree : m_subtrees)
+        {
+            subtree->actionChanged(action);
+        }
+    }
+
+    static void actionAddedOrRemoved(GActionGroup* actionGroup, gchar* name, gpointer user_data)
+    {
+        static_cast<TopLevelState*>(user_data)->actionChanged(actionGroup, name);
+    }
+
+    static void actionStateChanged(GActionGroup* actionGroup, gchar* name, GVariant*, gpointer user_data)
+    {
+        static_cast<TopLevelState*>(user_data)->actionChanged(actionGroup, name);
+    }
+
+    void watchActions(const map<string, shared_ptr<GActionGroup>>& actions)
+    {
+        for (const auto& action : actions)
+        {
+            GActionGroup* group = action.second.get();
+            if (!group)
+            {
+                continue;
+            }
+
+            for (gulong id : {
+                    g_signal_connect(group, "action-added", G_CALLBACK(&TopLevelState::actionAddedOrRemoved), this),
+                    g_signal_connect(group, "action-removed", G_CALLBACK(&TopLevelState::actionAddedOrRemoved), this),
+                    g_signal_connect(group, "action-state-changed", G_CALLBACK(&TopLevelState::actionStateChanged), this) })
+            {
+                m_actionWatches.emplace_back(action.second, id);
+            }
+        }
+    }
+};
 }
 
 struct MenuMatcher::Parameters::Priv
@@ -158,6 +333,17 @@ void MenuMatcher::match(MatchResult& matchResult) const
 {
     vector<unsigned int> location;
 
+    /* Items that matched in an earlier pass are only matched again when
+     * their part of the menu changed */
+    TopLevelState state;
+    for (size_t i = 0; i < p->m_items.size(); ++i)
+    {
+        state.m_subtrees.emplace_back(new SubtreeState);
+    }
+    state.watchActions(p->m_actions);
+    gulong changedId = g_signal_connect(p->m_menu.get(), "items-changed",
+                                        G_CALLBACK(&TopLevelState::changed), &state);
+
     while (true)
     {
         MatchResult childMatchResult(matchResult.createChild());
@@ -174,8 +360,29 @@ void MenuMatcher::match(MatchResult& matchResult) const
         {
             for (size_t i = 0; i < p->m_items.size(); ++i)
             {
+                auto& subtree = *state.m_subtrees.at(i);
+                if (subtree.m_matched && !subtree.m_dirty)
+                {
+                    continue;
+                }
+
+                subtree.unwatch();
+                subtree.beginMatch();
+
+                MatchResult itemMatchResult(childMatchResult.createChild());
                 const auto& matcher = p->m_items.at(i);
-                matcher.match(childMatchResult, location, p->m_menu, p->m_actions, i);
+                {
+                    ActionRecorder recorder;
+                    matcher.match(itemMatchResult, location, p->m_menu, p->m_actions, i);
+                    subtree.endMatch(recorder);
+                }
+
+                subtree.m_matched = itemMatchResult.success();
+                if (subtree.m_matched)
+                {
+                    subtree.watchLinks(p->m_menu.get(), i);
+                }
+                childMatchResult.merge(itemMatchResult);
             }
         }
 
@@ -194,6 +401,8 @@ void MenuMatcher::match(MatchResult& matchResult) const
             menuWaitForItems(p->m_menu);
         }
     }
+
+    g_signal_handler_disconnect(p->m_menu.get(), changedId);
 }
 
 MatchResult MenuMatcher::match() const
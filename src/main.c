@@ -103,6 +103,8 @@ main (int argc, char ** argv)
 
     g_main_loop_run(loop);
 
+    indicator_sound_debug_metrics_dump();
+
     g_clear_object(&service);
     g_clear_pointer(&pgloop, pa_glib_mainloop_free);
 
@@ -24,11 +24,23 @@ public interface UnityGreeterList : Object {
 }
 
 public class MediaPlayerListGreeter : MediaPlayerList {
+	/* Players of the users that were looked at last, including the prefetched ones */
+	const uint MAX_PLAYERS = 8;
+
 	string? selected_user = null;
 	UnityGreeterList? proxy = null;
 	HashTable<string, MediaPlayerUser> players = new HashTable<string, MediaPlayerUser>(str_hash, str_equal);
+	/* User names in players, most recently used first */
+	Queue<string> players_lru = new Queue<string>();
+
+	Act.UserManager accounts_manager = Act.UserManager.get_default();
+	/* User names in the order the greeter lists them, built when needed */
+	string[]? sorted_users = null;
 
 	public MediaPlayerListGreeter () {
+		accounts_manager.user_added.connect(users_changed);
+		accounts_manager.user_removed.connect(users_changed);
+
 		Bus.get_proxy.begin<UnityGreeterList> (
 			BusType.SESSION,
 			"com.canonical.UnityGreeter",
@@ -38,6 +50,15 @@ public class MediaPlayerListGreeter : MediaPlayerList {
 			new_proxy);
 	}
 
+	~MediaPlayerListGreeter () {
+		accounts_manager.user_added.disconnect(users_changed);
+		accounts_manager.user_removed.disconnect(users_changed);
+	}
+
+	void users_changed (Act.User user) {
+		sorted_users = null;
+	}
+
 	void new_proxy (GLib.Object? obj, AsyncResult res) {
 		try {
 			this.proxy = Bus.get_proxy.end(res);
@@ -75,10 +96,6 @@ public class MediaPlayerListGreeter : MediaPlayerList {
 			selected_user = null;
 		}
 
-		if (selected_user != null && !players.contains(selected_user)) {
-			players.insert(selected_user, new MediaPlayerUser(selected_user));
-		}
-
 		if (old_user != null) {
 			var old_player = players.lookup(old_user);
 			debug("Removing player for user: %s", old_user);
@@ -86,12 +103,75 @@ public class MediaPlayerListGreeter : MediaPlayerList {
 		}
 
 		if (selected_user != null) {
-			var new_player = players.lookup(selected_user);
+			/* Neighbours first, so that the selected user is the most recent one */
+			prefetch_neighbours(selected_user);
 
-			if (new_player != null) {
-				debug("Adding player for user: %s", selected_user);
-				player_added(new_player);
-			}
+			var new_player = get_player(selected_user);
+
+			debug("Adding player for user: %s", selected_user);
+			player_added(new_player);
+		}
+	}
+
+	/* Returns the player for @user, creating it if needed, and evicts the
+	   least recently used players beyond MAX_PLAYERS.  Evicted players are
+	   dropped, which disconnects them from the bus. */
+	MediaPlayerUser get_player (string user) {
+		var player = players.lookup(user);
+
+		if (player != null) {
+			players_lru.delete_link(players_lru.find_custom(user, strcmp));
+			players_lru.push_head(user);
+			return player;
+		}
+
+		player = new MediaPlayerUser(user);
+		players.insert(user, player);
+		players_lru.push_head(user);
+
+		while (players_lru.get_length() > MAX_PLAYERS) {
+			var evicted = players_lru.pop_tail();
+			debug("Dropping player for user: %s", evicted);
+			players.remove(evicted);
+		}
+
+		return player;
+	}
+
+	/* The greeter lists users by their real name */
+	static string user_label (Act.User user) {
+		var real_name = user.get_real_name();
+		return (real_name != null && real_name != "") ? real_name : user.get_user_name();
+	}
+
+	/* Sets up the players of the users next to @user in the greeter's list,
+	   so that their data is ready when the selection moves */
+	void prefetch_neighbours (string user) {
+		if (sorted_users == null) {
+			if (!accounts_manager.is_loaded)
+				return;
+
+			var users = new List<Act.User>();
+			foreach (var u in accounts_manager.list_users())
+				users.append(u);
+			users.sort((a, b) => {
+				return user_label(a).collate(user_label(b));
+			});
+
+			sorted_users = {};
+			foreach (var u in users)
+				sorted_users += u.get_user_name();
+		}
+
+		for (int i = 0; i < sorted_users.length; i++) {
+			if (sorted_users[i] != user)
+				continue;
+
+			if (i > 0)
+				get_player(sorted_users[i - 1]);
+			if (i + 1 < sorted_users.length)
+				get_player(sorted_users[i + 1]);
+			break;
 		}
 	}
 
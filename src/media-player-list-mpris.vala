@@ -23,10 +23,17 @@
  */
 public class MediaPlayerListMpris : MediaPlayerList {
 
+	/* including the first instance */
+	const uint MAX_INSTANCES_PER_PLAYER = 4;
+
 	public MediaPlayerListMpris () {
 		this._players = new HashTable<string, MediaPlayerMpris> (str_hash, str_equal);
+		this._players_by_dbus_name = new HashTable<string, MediaPlayerMpris> (str_hash, str_equal);
+		this._attach_order = new HashTable<string, uint> (str_hash, str_equal);
 
-		BusWatcher.watch_namespace (BusType.SESSION, "org.mpris.MediaPlayer2", this.player_appeared, this.player_disappeared);
+		/* owners are not needed, players are reached by their well-known names */
+		BusWatcher.watch_namespace_with_flags (BusType.SESSION, "org.mpris.MediaPlayer2", BusWatcher.NamespaceFlags.LAZY_OWNER,
+											   this.player_appeared, this.player_disappeared);
 	}
 
 	/* only valid while the list is not changed */
@@ -61,7 +68,7 @@ public class MediaPlayerListMpris : MediaPlayerList {
 		MediaPlayerMpris? player = this._players.lookup (id);
 
 		if (player == null) {
-			var appinfo = new DesktopAppInfo (id);
+			var appinfo = DesktopAppInfoCache.lookup (id);
 			if (appinfo == null) {
 				warning ("unable to find application '%s'", id);
 				return null;
@@ -75,6 +82,28 @@ public class MediaPlayerListMpris : MediaPlayerList {
 		return player;
 	}
 
+	/**
+	 * Adds a player for another running instance of @player, unless there are too many
+	 * instances of it already.
+	 */
+	MediaPlayerMpris? insert_extra_instance (MediaPlayerMpris player) {
+		for (uint instance = 2; instance <= MAX_INSTANCES_PER_PLAYER; instance++) {
+			if (!this._players.contains ("%s.%u".printf (player.id, instance))) {
+				var appinfo = DesktopAppInfoCache.lookup (player.id);
+				if (appinfo == null)
+					return null;
+
+				var extra = new MediaPlayerMpris (appinfo, instance);
+				this._players.insert (extra.id, extra);
+				this.player_added (extra);
+				return extra;
+			}
+		}
+
+		debug ("ignoring instance of '%s': too many instances are running", player.id);
+		return null;
+	}
+
 	/**
 	 * Removes the player associated with @desktop_id, unless it is currently running.
 	 */
@@ -111,13 +140,32 @@ public class MediaPlayerListMpris : MediaPlayerList {
 
 	HashTable<string, MediaPlayerMpris> _players;
 
-	void player_appeared (DBusConnection connection, string name, string owner) {
+	/* players that are attached to a running instance, by the instance's bus name */
+	HashTable<string, MediaPlayerMpris> _players_by_dbus_name;
+
+	/* when each of those instances was attached, to find the oldest one */
+	HashTable<string, uint> _attach_order;
+	uint _attach_count = 0;
+
+	void player_appeared (DBusConnection connection, string name, string? owner) {
 		try {
 			MprisRoot mpris2_root = Bus.get_proxy_sync (BusType.SESSION, name, MPRIS_MEDIA_PLAYER_PATH);
 
 			var player = this.insert (mpris2_root.DesktopEntry);
-			if (player != null)
+			/* the player is attached to another running instance already, so this one
+			   gets an entry of its own */
+			if (player != null && player.dbus_name != null)
+				player = this.insert_extra_instance (player);
+
+			if (player != null) {
 				player.attach (mpris2_root, name);
+
+				/* attach() fails if the player is already attached to another instance */
+				if (player.dbus_name == name) {
+					this._players_by_dbus_name.insert (name, player);
+					this._attach_order.insert (name, ++this._attach_count);
+				}
+			}
 		}
 		catch (Error e) {
 			warning ("unable to create mpris proxy for '%s': %s", name, e.message);
@@ -125,11 +173,52 @@ public class MediaPlayerListMpris : MediaPlayerList {
 	}
 
 	void player_disappeared (DBusConnection connection, string dbus_name) {
-		MediaPlayerMpris? player = this._players.find ( (name, player) => {
-			return player.dbus_name == dbus_name;
-		});
+		MediaPlayerMpris? player = this._players_by_dbus_name.lookup (dbus_name);
 
-		if (player != null)
+		if (player != null) {
+			this._players_by_dbus_name.remove (dbus_name);
+			this._attach_order.remove (dbus_name);
 			player.detach ();
+
+			if (player.is_extra_instance) {
+				this._players.remove (player.id);
+				this.player_removed (player);
+			}
+			else {
+				this.promote_extra_instance (connection, player);
+			}
+		}
+	}
+
+	/**
+	 * Moves the oldest extra instance of @player, if any is running, to @player's entry,
+	 * so that the player stays in the menu under its own name.
+	 */
+	void promote_extra_instance (DBusConnection connection, MediaPlayerMpris player) {
+		MediaPlayerMpris? oldest = null;
+		uint oldest_order = uint.MAX;
+
+		this._players_by_dbus_name.foreach ((name, extra) => {
+			if (extra.is_extra_instance && extra.id.has_prefix (player.id + ".")) {
+				uint order = this._attach_order.lookup (name);
+				if (order < oldest_order) {
+					oldest = extra;
+					oldest_order = order;
+				}
+			}
+		});
+
+		if (oldest == null)
+			return;
+
+		var dbus_name = oldest.dbus_name;
+		this._players_by_dbus_name.remove (dbus_name);
+		this._attach_order.remove (dbus_name);
+		oldest.detach ();
+		this._players.remove (oldest.id);
+		this.player_removed (oldest);
+
+		/* @player isn't attached any more, so the instance is attached to it */
+		this.player_appeared (connection, dbus_name, null);
 	}
 }
@@ -22,21 +22,37 @@
  */
 public class MediaPlayerMpris: MediaPlayer {
 
-	public MediaPlayerMpris (DesktopAppInfo appinfo) {
+	/**
+	 * Creates a player for @appinfo.  Additional instances of an application that is already
+	 * running get an @instance number starting at 2, which is appended to their id and name.
+	 */
+	public MediaPlayerMpris (DesktopAppInfo appinfo, uint instance = 0) {
 		this.appinfo = appinfo;
+		this.instance = instance;
+
+		if (instance != 0) {
+			this._id = "%s.%u".printf (appinfo.get_id (), instance);
+			this._name = "%s (%u)".printf (appinfo.get_name (), instance);
+		}
 	}
 
-	/** Desktop id of the player */
+	/** Desktop id of the player, with the instance number for extra instances */
 	public override string id {
 		get {
-			return this.appinfo.get_id ();
+			return this._id != null ? this._id : this.appinfo.get_id ();
 		}
 	}
 
 	/** Display name of the player */
 	public override string name {
 		get {
-			return this.appinfo.get_name ();
+			return this._name != null ? this._name : this.appinfo.get_name ();
+		}
+	}
+
+	public override bool is_extra_instance {
+		get {
+			return this.instance != 0;
 		}
 	}
 
@@ -91,6 +107,32 @@ public class MediaPlayerMpris: MediaPlayer {
 		}
 	}
 
+	public override int64 track_length {
+		get {
+			return this._track_length;
+		}
+	}
+
+	/* MPRIS doesn't signal position changes, so the position is only fetched from the player
+	 * when it jumps or the playback status changes */
+	public override int64 position {
+		get {
+			return this.proxy != null ? this.last_position : -1;
+		}
+	}
+
+	public override int64 position_time {
+		get {
+			return this.last_position_time;
+		}
+	}
+
+	public override double rate {
+		get {
+			return this._rate;
+		}
+	}
+
 	public override bool can_do_next {
 		get {
 			return this.proxy.CanGoNext;
@@ -126,6 +168,8 @@ public class MediaPlayerMpris: MediaPlayer {
 	public void detach () {
 		this.root = null;
 		this.proxy = null;
+		this.last_position = 0;
+		this._rate = 1.0;
 		this._dbus_name = null;
 		this.notify_property ("is-running");
 		this.notify_property ("can-raise");
@@ -203,12 +247,59 @@ public class MediaPlayerMpris: MediaPlayer {
 	}
 
 	DesktopAppInfo appinfo;
+	uint instance;
+	string? _id = null;
+	string? _name = null;
 	MprisPlayer? proxy;
 	MprisPlaylists ?playlists_proxy;
 	string _dbus_name;
 	bool play_when_attached = false;
 	MprisRoot root;
 	PlaylistDetails[] playlists = null;
+	int64 _track_length = 0;
+
+	/* last known position, at monotonic time last_position_time */
+	int64 last_position = 0;
+	int64 last_position_time = 0;
+	double _rate = 1.0;
+
+	void set_position (int64 position) {
+		this.last_position = position;
+		this.last_position_time = get_monotonic_time ();
+		this.position_changed ();
+	}
+
+	/* Fetches the current position from the player.  Position is not included in
+	 * "PropertiesChanged", so the proxy's cached value can't be used. */
+	void resync_position () {
+		var gproxy = this.proxy as DBusProxy;
+		gproxy.call.begin ("org.freedesktop.DBus.Properties.Get", new Variant ("(ss)", "org.mpris.MediaPlayer2.Player", "Position"),
+						   DBusCallFlags.NONE, -1, null, (obj, res) => {
+			try {
+				Variant position;
+				gproxy.call.end (res).get ("(v)", out position);
+				if ((this.proxy as DBusProxy) == gproxy && position.is_of_type (VariantType.INT64))
+					this.set_position (position.get_int64 ());
+			}
+			catch (Error e) {
+				debug ("unable to get the position of %s: %s", this.name, e.message);
+			}
+		});
+	}
+
+	void seeked (int64 position) {
+		this.set_position (position);
+	}
+
+	void update_rate (DBusProxy gproxy) {
+		var rate = gproxy.get_cached_property ("Rate");
+		double new_rate = rate != null && rate.is_of_type (VariantType.DOUBLE) ? rate.get_double () : 1.0;
+
+		/* rebase, so that the position up to now is extrapolated with the previous rate */
+		var position = this.get_position ();
+		this._rate = new_rate;
+		this.set_position (position);
+	}
 
 	void got_proxy (Object? obj, AsyncResult res) {
 		try {
@@ -223,6 +314,12 @@ public class MediaPlayerMpris: MediaPlayer {
 			this.state = this.proxy.PlaybackStatus != null ? this.proxy.PlaybackStatus : "Unknown";
 			this.update_current_track (gproxy.get_cached_property ("Metadata"));
 
+			/* the cached position is current, as the proxy was just created */
+			var position = gproxy.get_cached_property ("Position");
+			this.set_position (position != null && position.is_of_type (VariantType.INT64) ? position.get_int64 () : 0);
+			this.update_rate (gproxy);
+			this.proxy.Seeked.connect (this.seeked);
+
 			if (this.play_when_attached) {
 				/* wait a little before calling PlayPause, some players need some time to
 				   set themselves up */
@@ -261,7 +358,7 @@ public class MediaPlayerMpris: MediaPlayer {
 		try {
 			this.playlists_proxy = Bus.get_proxy.end (res);
 
-			var gproxy = this.proxy as DBusProxy;
+			var gproxy = this.playlists_proxy as DBusProxy;
 			gproxy.g_properties_changed.connect (this.playlists_proxy_properties_changed);
 		}
 		catch (Error e) {
@@ -288,7 +385,16 @@ public class MediaPlayerMpris: MediaPlayer {
 
 	void proxy_properties_changed (DBusProxy proxy, Variant changed_properties, string[] invalidated_properties) {
 		if (changed_properties.lookup ("PlaybackStatus", "s", null)) {
-			this.state = this.proxy.PlaybackStatus != null ? this.proxy.PlaybackStatus : "Unknown";
+			var state = this.proxy.PlaybackStatus != null ? this.proxy.PlaybackStatus : "Unknown";
+			if (state != this.state) {
+				/* freeze or restart the extrapolated position right away, then correct it */
+				this.set_position (this.get_position ());
+				this.state = state;
+				this.resync_position ();
+			}
+		}
+		if (changed_properties.lookup ("Rate", "d", null)) {
+			this.update_rate (proxy);
 		}
 		if (changed_properties.lookup ("CanGoNext", "b", null) || changed_properties.lookup ("CanGoPrevious", "b", null) ||
                     changed_properties.lookup ("CanPlay", "b", null) || changed_properties.lookup ("CanPause", "b", null)) {
@@ -305,16 +411,34 @@ public class MediaPlayerMpris: MediaPlayer {
 			this.fetch_playlists ();
 	}
 
+	/* Players often resend unchanged metadata along with other property changes.  Only
+	 * publish a new track (and thus notify "current-track") if the values actually differ. */
 	void update_current_track (Variant? metadata) {
 		if (metadata != null) {
-			this.current_track = new Track (
-				sanitize_metadata_value (metadata.lookup_value ("xesam:artist", null)),
-				sanitize_metadata_value (metadata.lookup_value ("xesam:title", null)),
-				sanitize_metadata_value (metadata.lookup_value ("xesam:album", null)),
-				sanitize_metadata_value (metadata.lookup_value ("mpris:artUrl", null))
-			);
+			var length = metadata.lookup_value ("mpris:length", null);
+			if (length != null && length.is_of_type (VariantType.INT64))
+				this._track_length = length.get_int64 ();
+			else if (length != null && length.is_of_type (VariantType.UINT64))
+				this._track_length = (int64) length.get_uint64 ();
+			else
+				this._track_length = 0;
+
+			var artist = sanitize_metadata_value (metadata.lookup_value ("xesam:artist", null));
+			var title = sanitize_metadata_value (metadata.lookup_value ("xesam:title", null));
+			var album = sanitize_metadata_value (metadata.lookup_value ("xesam:album", null));
+			var art_url = sanitize_metadata_value (metadata.lookup_value ("mpris:artUrl", null));
+
+			if (this.current_track != null && this.current_track.has_values (artist, title, album, art_url)) {
+				IndicatorSound.DebugMetrics.increment ("mpris-suppressed-track-updates");
+				return;
+			}
+
+			/* a new track starts at the beginning, unless the player says otherwise with "Seeked" */
+			this.set_position (0);
+			this.current_track = new Track (artist, title, album, art_url);
 		}
-		else {
+		else if (this.current_track != null) {
+			this._track_length = 0;
 			this.current_track = null;
 		}
 	}
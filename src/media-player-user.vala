@@ -32,20 +32,15 @@ public class MediaPlayerUser : MediaPlayer {
 	public MediaPlayerUser(string user) {
 		username = user;
 
+		/* Act.User objects are shared and outlive us, so only connect methods
+		   that are disconnected again when we go away */
 		actuser = accounts_manager.get_user(user);
-		actuser.notify["is-loaded"].connect(() => {
-			debug("User loaded");
+		actuser.sessions_changed.connect(user_sessions_changed);
+		actuser.notify["is-loaded"].connect(user_loaded);
 
-			this.proxy = null;
-
-			Bus.get_proxy.begin<AccountsServiceSoundSettings> (
-				BusType.SYSTEM,
-				"org.freedesktop.Accounts",
-				actuser.get_object_path(),
-				DBusProxyFlags.GET_INVALIDATED_PROPERTIES,
-				null,
-				new_proxy);
-		});
+		/* The greeter may have looked at this user before */
+		if (actuser.is_loaded)
+			user_loaded();
 
 		Bus.get_proxy.begin<GreeterBroadcast> (
 			BusType.SYSTEM,
@@ -57,6 +52,12 @@ public class MediaPlayerUser : MediaPlayer {
 	}
 
 	~MediaPlayerUser () {
+		actuser.sessions_changed.disconnect(user_sessions_changed);
+		actuser.notify["is-loaded"].disconnect(user_loaded);
+
+		if (this.proxy != null)
+			(this.proxy as DBusProxy).g_properties_changed.disconnect(proxy_properties_changed);
+
 		if (properties_timeout != 0) {
 			Source.remove(properties_timeout);
 			properties_timeout = 0;
@@ -110,24 +111,48 @@ public class MediaPlayerUser : MediaPlayer {
 		}
 	}
 
+	/* Logging in or out changes whether the exported data is valid */
+	void user_sessions_changed () {
+		debug("Sessions changed for user: %s", this.username);
+		queue_property_notification("Timestamp");
+	}
+
+	void user_loaded () {
+		debug("User loaded");
+
+		if (this.proxy != null)
+			(this.proxy as DBusProxy).g_properties_changed.disconnect(proxy_properties_changed);
+		this.proxy = null;
+
+		Bus.get_proxy.begin<AccountsServiceSoundSettings> (
+			BusType.SYSTEM,
+			"org.freedesktop.Accounts",
+			actuser.get_object_path(),
+			DBusProxyFlags.GET_INVALIDATED_PROPERTIES,
+			null,
+			new_proxy);
+	}
+
+	void proxy_properties_changed (DBusProxy proxy, Variant changed, string[] invalidated) {
+		string key = "";
+		Variant value;
+		VariantIter iter = new VariantIter(changed);
+
+		while (iter.next("{sv}", &key, &value)) {
+			queue_property_notification(key);
+		}
+
+		foreach (var invalid in invalidated) {
+			queue_property_notification(invalid);
+		}
+	}
+
 	void new_proxy (GLib.Object? obj, AsyncResult res) {
 		try {
 			this.proxy = Bus.get_proxy.end (res);
 
 			var gproxy = this.proxy as DBusProxy;
-			gproxy.g_properties_changed.connect ((proxy, changed, invalidated) => {
-				string key = "";
-				Variant value;
-				VariantIter iter = new VariantIter(changed);
-
-				while (iter.next("{sv}", &key, &value)) {
-					queue_property_notification(key);
-				}
-
-				foreach (var invalid in invalidated) {
-					queue_property_notification(invalid);
-				}
-			});
+			gproxy.g_properties_changed.connect (proxy_properties_changed);
 
 			debug("Notifying player is ready for user: %s", this.username);
 			this.notify_property("is-running");
@@ -142,8 +167,14 @@ public class MediaPlayerUser : MediaPlayer {
 			return false;
 		}
 
-		/* More than 10 minutes old */
-		if (this.proxy.timestamp < GLib.get_monotonic_time() - 10 * 60 * 1000 * 1000) {
+		/* Cleared by the user's session when its player went away */
+		if (this.proxy.timestamp == 0) {
+			return false;
+		}
+
+		/* There is no heartbeat, so data left behind by a session that
+		   ended without clearing it is only caught here */
+		if (!this.actuser.is_logged_in()) {
 			return false;
 		}
 
@@ -30,6 +30,9 @@ public abstract class MediaPlayer : Object {
 	public virtual bool can_do_prev { get { not_implemented(); return false; } }
 	public virtual bool can_do_play { get { not_implemented(); return false; } }
 
+	/* Additional running instances of a player are shown, but not remembered */
+	public virtual bool is_extra_instance { get { return false; } }
+
 	public class Track : Object {
 		public string artist { get; construct; }
 		public string title { get; construct; }
@@ -39,6 +42,12 @@ public abstract class MediaPlayer : Object {
 		public Track (string artist, string title, string album, string art_url) {
 			Object (artist: artist, title: title, album: album, art_url: art_url);
 		}
+
+		/* Returns true if this track has exactly the given values */
+		public bool has_values (string artist, string title, string album, string art_url) {
+			return artist == this.artist && title == this.title &&
+			       album == this.album && art_url == this.art_url;
+		}
 	}
 
 	public virtual Track? current_track {
@@ -46,6 +55,35 @@ public abstract class MediaPlayer : Object {
 		set { not_implemented(); }
 	}
 
+	/* Length of the current track in microseconds, or 0 if it isn't known */
+	public virtual int64 track_length { get { return 0; } }
+
+	/**
+	 * The playback position in the current track in microseconds at the monotonic time
+	 * position_time, or -1 if it isn't known.  While playing, the position advances from
+	 * there at the playback rate.  position_changed is emitted when it stops doing so:
+	 * on seeks, new tracks and changes of the rate or the playback status.
+	 */
+	public virtual int64 position { get { return -1; } }
+	public virtual int64 position_time { get { return 0; } }
+	public virtual double rate { get { return 1.0; } }
+
+	/* Returns the position extrapolated to now, or -1 if it isn't known */
+	public int64 get_position () {
+		if (this.position < 0)
+			return -1;
+
+		int64 position = this.position;
+		if (this.state == "Playing")
+			position += (int64) ((get_monotonic_time () - this.position_time) * this.rate);
+
+		if (this.track_length > 0 && position > this.track_length)
+			position = this.track_length;
+
+		return int64.max (position, 0);
+	}
+
+	public signal void position_changed ();
 	public signal void playlists_changed ();
 	public signal void playbackstatus_changed ();
 
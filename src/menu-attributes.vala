@@ -0,0 +1,92 @@
+/*
+ * Copyright 2016 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * A pool of menu attribute values.  The menus of all profiles set the same
+ * icons, types and slider ranges on their items over and over again; taking
+ * the values from here makes them share a single immutable GVariant each,
+ * instead of allocating (and serializing icons) for every new item.
+ */
+public class MenuAttributes {
+	/* Player icons can be anything, keep the tables bounded */
+	const uint MAX_ENTRIES = 64;
+
+	static HashTable<Variant, Variant>? values = null;
+	static HashTable<Icon, Variant>? icons = null;
+	static HashTable<string, Variant>? themed_icons = null;
+
+	/* Returns the shared instance of @value, which must be of a basic type */
+	public static Variant intern (Variant value) {
+		if (values == null)
+			values = new HashTable<Variant, Variant> (Variant.hash, Variant.equal);
+
+		unowned Variant? shared = values.lookup (value);
+		if (shared != null)
+			return shared;
+
+		if (values.size () >= MAX_ENTRIES)
+			values.remove_all ();
+
+		values.insert (value, value);
+		return value;
+	}
+
+	public static Variant for_string (string value) {
+		return intern (new Variant.string (value));
+	}
+
+	public static Variant for_double (double value) {
+		return intern (new Variant.double (value));
+	}
+
+	/* Returns the shared serialization of @icon, or null if it can't be serialized */
+	public static Variant? for_icon (Icon icon) {
+		if (icons == null)
+			icons = new HashTable<Icon, Variant> (Icon.hash, Icon.equal);
+
+		unowned Variant? serialized = icons.lookup (icon);
+		if (serialized != null)
+			return serialized;
+
+		var value = icon.serialize ();
+		if (value == null)
+			return null;
+
+		if (icons.size () >= MAX_ENTRIES)
+			icons.remove_all ();
+
+		icons.insert (icon, value);
+		return value;
+	}
+
+	/* Returns the shared serialization of a themed icon with default fallbacks */
+	public static Variant for_themed_icon (string icon_name) {
+		if (themed_icons == null)
+			themed_icons = new HashTable<string, Variant> (str_hash, str_equal);
+
+		unowned Variant? serialized = themed_icons.lookup (icon_name);
+		if (serialized != null)
+			return serialized;
+
+		if (themed_icons.size () >= MAX_ENTRIES)
+			themed_icons.remove_all ();
+
+		var icon = new ThemedIcon.with_default_fallbacks (icon_name);
+		var value = icon.serialize ();
+		themed_icons.insert (icon_name, value);
+		return value;
+	}
+}
@@ -37,6 +37,7 @@ public interface MprisPlayer : Object {
   // properties
   public abstract HashTable<string, Variant?> Metadata{owned get; set;}
   public abstract int64 Position{owned get; set;}
+  public abstract double Rate{owned get; set;}
   public abstract string? PlaybackStatus{owned get; set;}
   public abstract bool CanPlay{owned get; set;}
   public abstract bool CanGoNext{owned get; set;}
@@ -20,13 +20,101 @@
 public abstract class IndicatorSound.Notification: Object
 {
 	public Notification () {
-		BusWatcher.watch_namespace (
+		watch_server ();
+
+		/* The watch may already have seen the server, but lost its capabilities */
+		if (_server_caps == null)
+			fetch_server_caps.begin ();
+
+		_notification = create_notification ();
+	}
+
+	/* All notification types share one watch of the notification server and
+	 * one copy of its capabilities */
+	private static void watch_server () {
+		if (_server_watch != 0)
+			return;
+
+		_server_watch = BusWatcher.watch_namespace (
 			GLib.BusType.SESSION,
 			"org.freedesktop.Notifications",
-			() => { debug ("Notifications name appeared"); },
-			() => { debug ("Notifications name vanshed"); _server_caps = null; });
+			() => {
+				debug ("Notifications name appeared");
+				fetch_server_caps.begin ();
+			},
+			(connection) => {
+				debug ("Notifications name vanshed");
+				forget_server_caps ();
+			});
 
-		_notification = create_notification ();
+		watch_server_connection.begin ();
+	}
+
+	/* The watch stops with its connection, without a word when no server was
+	 * known by then, so it is dropped when the connection closes instead */
+	private static async void watch_server_connection () {
+		try {
+			var connection = yield Bus.get (BusType.SESSION);
+			if (connection.is_closed ()) {
+				server_connection_closed ();
+				return;
+			}
+
+			connection.closed.connect ((remote_peer_vanished, error) => {
+				server_connection_closed ();
+			});
+		} catch (Error e) {
+			debug ("Unable to get the session bus: %s", e.message);
+			server_connection_closed ();
+		}
+	}
+
+	/* Lets the next notification watch again */
+	private static void server_connection_closed () {
+		_server_watch = 0;
+		forget_server_caps ();
+	}
+
+	private static void forget_server_caps () {
+		_server_caps = null;
+		_server_caps_serial++;
+	}
+
+	/* Asks the server for its capabilities without blocking, so that they are known
+	 * by the time the first bubble is shown */
+	private static async void fetch_server_caps () {
+		/* a fetch that was started before the server vanished is superseded */
+		var serial = _server_caps_serial;
+		if (_server_caps_pending == serial)
+			return;
+
+		_server_caps_pending = serial;
+
+		try {
+			var connection = yield Bus.get (BusType.SESSION);
+			var reply = yield connection.call ("org.freedesktop.Notifications",
+			                                   "/org/freedesktop/Notifications",
+			                                   "org.freedesktop.Notifications",
+			                                   "GetCapabilities",
+			                                   null,
+			                                   new VariantType ("(as)"),
+			                                   DBusCallFlags.NONE,
+			                                   -1,
+			                                   null);
+
+			if (serial != _server_caps_serial)
+				return;
+
+			var caps = new List<string> ();
+			foreach (var cap in reply.get_child_value (0).get_strv ())
+				caps.prepend (cap);
+			_server_caps = (owned) caps;
+		} catch (Error e) {
+			debug ("Unable to get the notification server's capabilities: %s", e.message);
+		}
+
+		if (serial == _server_caps_serial)
+			_server_caps_pending = -1;
 	}
 
 	public void close () {
@@ -57,9 +145,18 @@ public abstract class IndicatorSound.Notification: Object
 		}
 	}
 
+	/* Whether the notification server's capabilities have arrived */
+	public static bool server_caps_known () {
+		return _server_caps != null;
+	}
+
+	/* Never blocks: while the capabilities are unknown, nothing is supported and a
+	 * fetch is started for the next time */
 	protected bool notify_server_supports (string cap) {
-		if (_server_caps == null)
-			_server_caps = Notify.get_server_caps ();
+		if (_server_caps == null) {
+			fetch_server_caps.begin ();
+			return false;
+		}
 
 		return _server_caps.find_custom (cap, strcmp) != null;
 	}
@@ -67,4 +164,7 @@ public abstract class IndicatorSound.Notification: Object
 	protected Notify.Notification _notification = null;
 
 	private static List<string> _server_caps = null;
+	private static int _server_caps_serial = 0;
+	private static int _server_caps_pending = -1;
+	private static uint _server_watch = 0;
 }
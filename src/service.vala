@@ -79,6 +79,8 @@ public class IndicatorSound.Service: Object {
 			this.export_to_accounts_service = this.accounts_service.showDataOnGreeter;
 		}
 
+		ArtCache.get_default ().thumbnail_ready.connect (this.art_thumbnail_ready);
+
 		this.players = playerlist;
 		this.players.player_added.connect (this.player_added);
 		this.players.player_removed.connect (this.player_removed);
@@ -92,34 +94,22 @@ public class IndicatorSound.Service: Object {
 		this.actions.add_action (this.create_high_volume_action ());
 		this.actions.add_action (this.create_volume_sync_action ());
 
-		this.menus = new HashTable<string, SoundMenu> (str_hash, str_equal);
-		this.menus.insert ("desktop_greeter", new SoundMenu (null, SoundMenu.DisplayFlags.SHOW_MUTE | SoundMenu.DisplayFlags.HIDE_PLAYERS | SoundMenu.DisplayFlags.GREETER_PLAYERS));
-		this.menus.insert ("phone_greeter", new SoundMenu (null, SoundMenu.DisplayFlags.SHOW_SILENT_MODE | SoundMenu.DisplayFlags.HIDE_INACTIVE_PLAYERS | SoundMenu.DisplayFlags.GREETER_PLAYERS));
-		this.menus.insert ("desktop", new SoundMenu ("indicator.desktop-settings", SoundMenu.DisplayFlags.SHOW_MUTE | SoundMenu.DisplayFlags.HIDE_INACTIVE_PLAYERS_PLAY_CONTROLS | SoundMenu.DisplayFlags.ADD_PLAY_CONTROL_INACTIVE_PLAYER));
-		this.menus.insert ("phone", new SoundMenu ("indicator.phone-settings", SoundMenu.DisplayFlags.SHOW_SILENT_MODE | SoundMenu.DisplayFlags.HIDE_INACTIVE_PLAYERS));
-
-		this.menus.@foreach ( (profile, menu) => {
-			this.volume_control.bind_property ("active-mic", menu, "show-mic-volume", BindingFlags.SYNC_CREATE);
-		});
-
-		this.menus.@foreach ( (profile, menu) => {
-			_volume_warning.bind_property ("high-volume", menu, "show-high-volume-warning", BindingFlags.SYNC_CREATE);
-		});
+		this.menus = new SoundMenuCore ();
+		this.menus.add_profile ("desktop_greeter", new SoundMenu (null, SoundMenu.DisplayFlags.SHOW_MUTE | SoundMenu.DisplayFlags.HIDE_PLAYERS | SoundMenu.DisplayFlags.GREETER_PLAYERS));
+		this.menus.add_profile ("phone_greeter", new SoundMenu (null, SoundMenu.DisplayFlags.SHOW_SILENT_MODE | SoundMenu.DisplayFlags.HIDE_INACTIVE_PLAYERS | SoundMenu.DisplayFlags.GREETER_PLAYERS));
+		this.menus.add_profile ("desktop", new SoundMenu ("indicator.desktop-settings", SoundMenu.DisplayFlags.SHOW_MUTE | SoundMenu.DisplayFlags.HIDE_INACTIVE_PLAYERS_PLAY_CONTROLS | SoundMenu.DisplayFlags.ADD_PLAY_CONTROL_INACTIVE_PLAYER));
+		this.menus.add_profile ("phone", new SoundMenu ("indicator.phone-settings", SoundMenu.DisplayFlags.SHOW_SILENT_MODE | SoundMenu.DisplayFlags.HIDE_INACTIVE_PLAYERS));
 
-		this.menus.@foreach ( (profile, menu) => {
-			this.volume_control.active_output_changed.connect (menu.update_volume_slider);
-		});
+		this.volume_control.bind_property ("active-mic", this.menus, "show-mic-volume", BindingFlags.SYNC_CREATE);
+		_volume_warning.bind_property ("high-volume", this.menus, "show-high-volume-warning", BindingFlags.SYNC_CREATE);
+		this.volume_control.active_output_changed.connect (this.menus.update_volume_slider);
 
-		this.menus.@foreach ( (profile, menu) => {
-			menu.last_player_updated.connect ((player_id) => { 
-				this._accounts_service_access.last_running_player = player_id;
-			});
+		this.menus.last_player_updated.connect ((player_id) => {
+			this._accounts_service_access.last_running_player = player_id;
 		});
 
 		this._accounts_service_access.notify["last-running-player"].connect(() => {
-			this.menus.@foreach ( (profile, menu) => {
-				menu.set_default_player (this._accounts_service_access.last_running_player);
-			});
+			this.menus.set_default_player (this._accounts_service_access.last_running_player);
 		});
 
 		this.sync_preferred_players ();
@@ -137,6 +127,8 @@ public class IndicatorSound.Service: Object {
 			} else {
 				debug("Indicator is hidden");
 			}
+			this.indicator_shown = state.get_boolean ();
+			this.update_player_progress ();
 		});
 
 		/* Everything is built, let's put it on the bus */
@@ -146,7 +138,7 @@ public class IndicatorSound.Service: Object {
 			critical ("%s", e.message);
 		}
 
-		this.menus.@foreach ( (profile, menu) => menu.export (bus, @"/com/canonical/indicator/sound/$profile"));
+		this.menus.export (bus);
 	}
 
 	~Service() {
@@ -192,11 +184,12 @@ public class IndicatorSound.Service: Object {
 	};
 
 	SimpleActionGroup actions;
-	HashTable<string, SoundMenu> menus;
+	SoundMenuCore menus;
 	Settings settings;
 	VolumeControl volume_control;
 	MediaPlayerList players;
 	uint player_action_update_id;
+	bool indicator_shown = false;
 	bool mute_blocks_sound;
 	uint sound_was_blocked_timeout_id;
 	bool syncing_preferred_players = false;
@@ -507,7 +500,20 @@ public class IndicatorSound.Service: Object {
 			builder.add ("{sv}", "title", new Variant ("s", player.current_track.title));
 			builder.add ("{sv}", "artist", new Variant ("s", player.current_track.artist));
 			builder.add ("{sv}", "album", new Variant ("s", player.current_track.album));
-			builder.add ("{sv}", "art-url", new Variant ("s", player.current_track.art_url));
+			builder.add ("{sv}", "art-url", new Variant ("s", ArtCache.get_default ().lookup (player.current_track.art_url)));
+
+			/* only publish progress while someone can see it.  Clients extrapolate the
+			 * position from here while the player is playing:
+			 * position + (now - position-time) * rate, with now from the monotonic clock */
+			if (this.indicator_shown) {
+				if (player.position >= 0) {
+					builder.add ("{sv}", "position", new Variant ("x", player.position));
+					builder.add ("{sv}", "position-time", new Variant ("x", player.position_time));
+					builder.add ("{sv}", "rate", new Variant ("d", player.rate));
+				}
+				if (player.track_length > 0)
+					builder.add ("{sv}", "length", new Variant ("x", player.track_length));
+			}
 		}
 		return builder.end ();
 	}
@@ -547,6 +553,31 @@ public class IndicatorSound.Service: Object {
 			this.player_action_update_id = Idle.add (this.update_player_actions);
 	}
 
+	/* Republishes the action state of all players when the menu is opened or closed,
+	 * so that their progress comes and goes with it.  Doesn't go through
+	 * update_player_actions(), which also writes to AccountsService. */
+	void update_player_progress () {
+		foreach (var player in this.players)
+			this.update_player_state (player);
+	}
+
+	/* Republishes the action state of a player whose position jumped, if it is
+	 * being shown at all */
+	void player_position_changed (MediaPlayer player) {
+		if (this.indicator_shown)
+			this.update_player_state (player);
+	}
+
+	void update_player_state (MediaPlayer player) {
+		SimpleAction? action = this.actions.lookup_action (player.id) as SimpleAction;
+		if (action != null)
+			action.set_state (this.action_state_for_player (player));
+	}
+
+	void art_thumbnail_ready (string art_url) {
+		eventually_update_player_actions ();
+	}
+
 
 	void sync_preferred_players () {
 		this.syncing_preferred_players = true;
@@ -558,14 +589,16 @@ public class IndicatorSound.Service: Object {
 		/* only write the key if we're not getting this call because we're syncing from the key right now */
 		if (!this.syncing_preferred_players) {
 			var builder = new VariantBuilder (VariantType.STRING_ARRAY);
-			foreach (var player in this.players)
-				builder.add ("s", player.id);
+			foreach (var player in this.players) {
+				if (!player.is_extra_instance)
+					builder.add ("s", player.id);
+			}
 			this.settings.set_value ("interested-media-players", builder.end ());
 		}
 	}
 
 	void player_added (MediaPlayer player) {
-		this.menus.@foreach ( (profile, menu) => menu.add_player (player));
+		this.menus.add_player (player);
 
 		SimpleAction action = new SimpleAction.stateful (player.id, null, this.action_state_for_player (player));
 		action.set_enabled (player.can_raise);
@@ -580,9 +613,7 @@ public class IndicatorSound.Service: Object {
 		var play_action = new SimpleAction.stateful ("play." + player.id, null, player.state);
 		play_action.activate.connect ( () => player.play_pause () );
 		this.actions.add_action (play_action);
-		player.notify["state"].connect ( (object, pspec) => {
-			play_action.set_state (player.state);
-		});
+		player.notify["state"].connect (this.player_state_changed);
 
 		var next_action = new SimpleAction ("next." + player.id, null);
 		next_action.activate.connect ( () => player.next () );
@@ -597,20 +628,31 @@ public class IndicatorSound.Service: Object {
 		this.actions.add_action (playlist_action);
 
 		player.notify.connect (this.eventually_update_player_actions);
+		player.position_changed.connect (this.player_position_changed);
 
 		this.update_preferred_players ();
 	}
 
+	void player_state_changed (Object object, ParamSpec pspec) {
+		var player = object as MediaPlayer;
+		var play_action = this.actions.lookup_action ("play." + player.id) as SimpleAction;
+		if (play_action != null)
+			play_action.set_state (player.state);
+	}
+
 	void player_removed (MediaPlayer player) {
 		this.actions.remove_action (player.id);
+		this.actions.remove_action (player.id + ".greeter");
 		this.actions.remove_action ("play." + player.id);
 		this.actions.remove_action ("next." + player.id);
 		this.actions.remove_action ("previous." + player.id);
 		this.actions.remove_action ("play-playlist." + player.id);
 
 		player.notify.disconnect (this.eventually_update_player_actions);
+		player.position_changed.disconnect (this.player_position_changed);
+		player.notify["state"].disconnect (this.player_state_changed);
 
-		this.menus.@foreach ( (profile, menu) => menu.remove_player (player));
+		this.menus.remove_player (player);
 
 		this.update_preferred_players ();
 	}
@@ -0,0 +1,124 @@
+/*
+ * Copyright 2016 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * The sound menus of all profiles.  Changes to the state they have in common
+ * arrive here once, are computed once and are then applied to each profile's
+ * menu, all in one BatchedMenu transaction.  The menus share the resulting
+ * items (see SoundMenu.get_volume_slider()), so a profile only pays for
+ * placing them in its own layout.
+ */
+public class SoundMenuCore : Object {
+	public SoundMenuCore () {
+		this.menus = new HashTable<string, SoundMenu> (str_hash, str_equal);
+	}
+
+	public void add_profile (string profile, SoundMenu menu) {
+		this.menus.insert (profile, menu);
+
+		BatchedMenu.begin ();
+		menu.show_mic_volume = this.mic_volume_shown;
+		menu.show_high_volume_warning = this.high_volume_warning_shown;
+		menu.set_volume_slider_label (this.volume_slider_label);
+		BatchedMenu.commit ();
+
+		menu.last_player_updated.connect (this.menu_last_player_updated);
+	}
+
+	public void export (DBusConnection connection) {
+		this.menus.@foreach ((profile, menu) => menu.export (connection, @"/com/canonical/indicator/sound/$profile"));
+	}
+
+	public bool show_mic_volume {
+		get {
+			return this.mic_volume_shown;
+		}
+		set {
+			if (value == this.mic_volume_shown)
+				return;
+
+			this.mic_volume_shown = value;
+			BatchedMenu.begin ();
+			this.menus.@foreach ((profile, menu) => menu.show_mic_volume = value);
+			BatchedMenu.commit ();
+		}
+	}
+
+	public bool show_high_volume_warning {
+		get {
+			return this.high_volume_warning_shown;
+		}
+		set {
+			if (value == this.high_volume_warning_shown)
+				return;
+
+			this.high_volume_warning_shown = value;
+			BatchedMenu.begin ();
+			this.menus.@foreach ((profile, menu) => menu.show_high_volume_warning = value);
+			BatchedMenu.commit ();
+		}
+	}
+
+	public void update_volume_slider (VolumeControl.ActiveOutput active_output) {
+		var label = SoundMenu.volume_slider_label_for (active_output);
+		if (label == this.volume_slider_label)
+			return;
+
+		this.volume_slider_label = label;
+		BatchedMenu.begin ();
+		this.menus.@foreach ((profile, menu) => menu.set_volume_slider_label (label));
+		BatchedMenu.commit ();
+	}
+
+	public void add_player (MediaPlayer player) {
+		BatchedMenu.begin ();
+		this.menus.@foreach ((profile, menu) => menu.add_player (player));
+		BatchedMenu.commit ();
+	}
+
+	public void remove_player (MediaPlayer player) {
+		BatchedMenu.begin ();
+		this.menus.@foreach ((profile, menu) => menu.remove_player (player));
+		BatchedMenu.commit ();
+	}
+
+	public void set_default_player (string default_player_id) {
+		/* whatever is stored now doesn't need to be stored again */
+		this.last_player = default_player_id;
+
+		BatchedMenu.begin ();
+		this.menus.@foreach ((profile, menu) => menu.set_default_player (default_player_id));
+		BatchedMenu.commit ();
+	}
+
+	/* Emitted once when the menus find a new last running player, rather than
+	 * once by each of them */
+	public signal void last_player_updated (string player_id);
+
+	HashTable<string, SoundMenu> menus;
+	bool mic_volume_shown = false;
+	bool high_volume_warning_shown = false;
+	string volume_slider_label = _("Volume");
+	string last_player = "";
+
+	void menu_last_player_updated (string player_id) {
+		if (player_id == this.last_player)
+			return;
+
+		this.last_player = player_id;
+		this.last_player_updated (player_id);
+	}
+}
@@ -44,7 +44,7 @@ public class SoundMenu: Object
 		 * it has a dynamic amount of player sections, one for each registered player.
 		 */
 
-		this.volume_section = new Menu ();
+		this.volume_section = new BatchedMenu ();
 
 		if ((flags & DisplayFlags.SHOW_MUTE) != 0)
 			volume_section.append (_("Mute"), "indicator.mute");
@@ -54,11 +54,10 @@ public class SoundMenu: Object
 			volume_section.append_item(item);
 		}
 
-		volume_section.append_item (this.create_slider_menu_item (_("Volume"), "indicator.volume(0)", 0.0, 1.0, 0.01,
-																  "audio-volume-low-zero-panel",
-																  "audio-volume-high-panel", true));
+		this.volume_slider_label = _("Volume");
+		volume_section.append_item (get_volume_slider (this.volume_slider_label));
 
-		this.menu = new Menu ();
+		this.menu = new BatchedMenu ();
 		this.menu.append_section (null, volume_section);
 
 		if (settings_action != null) {
@@ -81,6 +80,9 @@ public class SoundMenu: Object
 		this.hide_inactive_player_controls = (flags & DisplayFlags.HIDE_INACTIVE_PLAYERS_PLAY_CONTROLS) != 0;
 		this.add_play_button_inactive_player = (flags & DisplayFlags.ADD_PLAY_CONTROL_INACTIVE_PLAYER) != 0;
 		this.notify_handlers = new HashTable<MediaPlayer, ulong> (direct_hash, direct_equal);
+		this.player_sections = new HashTable<MediaPlayer, int> (direct_hash, direct_equal);
+		this.inactive_player_controls = new HashTable<MediaPlayer, bool> (direct_hash, direct_equal);
+		this.playlists = new HashTable<MediaPlayer, Playlists> (direct_hash, direct_equal);
 
 		this.greeter_players = (flags & DisplayFlags.GREETER_PLAYERS) != 0;
 	}
@@ -93,6 +95,8 @@ public class SoundMenu: Object
 	}
 
 	public void set_default_player (string default_player_id) {
+		BatchedMenu.begin ();
+
 		this.default_player = default_player_id;
 		foreach (var player_stored in notify_handlers.get_keys ()) {
 			int index = this.find_player_section(player_stored);
@@ -100,6 +104,8 @@ public class SoundMenu: Object
 				add_player_playback_controls (player_stored, index, true);
 			}
 		}
+
+		BatchedMenu.commit ();
 	}
 
 	DBusConnection? bus = null;
@@ -120,17 +126,20 @@ public class SoundMenu: Object
 		}
 		set {
 			if (value && !this.mic_volume_shown) {
-				var slider = this.create_slider_menu_item (_("Microphone Volume"), "indicator.mic-volume", 0.0, 1.0, 0.01,
-														   "audio-input-microphone-low-zero-panel",
-														   "audio-input-microphone-high-panel", false);
-				volume_section.append_item (slider);
+				if (mic_slider == null)
+					mic_slider = create_slider_menu_item (_("Microphone Volume"), "indicator.mic-volume", 0.0, 1.0, 0.01,
+														  "audio-input-microphone-low-zero-panel",
+														  "audio-input-microphone-high-panel", false);
+				volume_section.append_item (mic_slider);
 				this.mic_volume_shown = true;
 			}
 			else if (!value && this.mic_volume_shown) {
 				int location = -1;
+				BatchedMenu.begin ();
 				while ((location = find_action(this.volume_section, "indicator.mic-volume")) != -1) {
 					this.volume_section.remove (location);
 				}
+				BatchedMenu.commit ();
 				this.mic_volume_shown = false;
 			}
 		}
@@ -143,21 +152,24 @@ public class SoundMenu: Object
 		set {
 			if (value && !this.high_volume_warning_shown) {
 				/* NOTE: Action doesn't really exist, just used to find below when removing */
-				var item = new MenuItem(_("High volume can damage your hearing."), "indicator.high-volume-warning-item");
-				volume_section.append_item (item);
+				if (high_volume_warning_item == null)
+					high_volume_warning_item = new MenuItem(_("High volume can damage your hearing."), "indicator.high-volume-warning-item");
+				volume_section.append_item (high_volume_warning_item);
 				this.high_volume_warning_shown = true;
 			}
 			else if (!value && this.high_volume_warning_shown) {
 				int location = -1;
+				BatchedMenu.begin ();
 				while ((location = find_action(this.volume_section, "indicator.high-volume-warning-item")) != -1) {
 					this.volume_section.remove (location);
 				}
+				BatchedMenu.commit ();
 				this.high_volume_warning_shown = false;
 			}
 		}
 	}
 
-	int find_action (Menu menu, string in_action) {
+	int find_action (MenuModel menu, string in_action) {
 		int n = menu.get_n_items ();
 		for (int i = 0; i < n; i++) {
 			string action;
@@ -169,8 +181,10 @@ public class SoundMenu: Object
 		return -1;
 	}
 
+	/* Only inactive players that show playback controls can be affected by
+	 * another player starting or stopping */
 	public void update_all_players_play_section() {
-		foreach (var player_stored in notify_handlers.get_keys ()) {
+		foreach (var player_stored in inactive_player_controls.get_keys ()) {
 			int index = this.find_player_section(player_stored);
 			if (index != -1) {
 				// just update to verify if we must hide the player controls
@@ -193,11 +207,15 @@ public class SoundMenu: Object
 		if (this.notify_handlers.contains (player))
 			return;
 
+		BatchedMenu.begin ();
 		if (player.is_running || !this.hide_inactive)
 			this.insert_player_section (player);
 		this.update_playlists (player);
+		BatchedMenu.commit ();
 
 		var handler_id = player.notify["is-running"].connect ( () => {
+			BatchedMenu.begin ();
+
 			int index = this.find_player_section(player);
 			if (player.is_running) {
 				if (index == -1) {
@@ -212,15 +230,21 @@ public class SoundMenu: Object
 			}
 			this.update_playlists (player);
 
+			index = this.find_player_section(player);
+			if (index != -1)
+				update_player_section (player, index);
+
 			// we need to update the rest of players, because we might have
 			// a non running player still showing the playback controls
 			update_all_players_play_section();
 
+			BatchedMenu.commit ();
+
 			check_last_running_player ();
 		});
 		this.notify_handlers.insert (player, handler_id);
 
-		player.playlists_changed.connect (this.update_playlists);
+		player.playlists_changed.connect (this.player_playlists_changed);
 		player.playbackstatus_changed.connect (this.update_playbackstatus);
 
 		check_last_running_player ();
@@ -234,7 +258,8 @@ public class SoundMenu: Object
 			player.disconnect(id);
 		}
 
-		player.playlists_changed.disconnect (this.update_playlists);
+		player.playlists_changed.disconnect (this.player_playlists_changed);
+		player.playbackstatus_changed.disconnect (this.update_playbackstatus);
 
 		/* this'll drop our ref to it */
 		this.notify_handlers.remove (player);
@@ -242,46 +267,79 @@ public class SoundMenu: Object
 		check_last_running_player ();
 	}
 
+	/* Returns the label of the volume slider when @active_output is in use */
+	public static string volume_slider_label_for (VolumeControl.ActiveOutput active_output) {
+		string label = _("Volume");
+		switch (active_output) {
+			case VolumeControl.ActiveOutput.SPEAKERS:
+				label = _("Volume");
+				break;
+			case VolumeControl.ActiveOutput.HEADPHONES:
+				label = _("Volume (Headphones)");
+				break;
+			case VolumeControl.ActiveOutput.BLUETOOTH_SPEAKER:
+				label = _("Volume (Bluetooth)");
+				break;
+			case VolumeControl.ActiveOutput.USB_SPEAKER:
+				label = _("Volume (Usb)");
+				break;
+			case VolumeControl.ActiveOutput.HDMI_SPEAKER:
+				label = _("Volume (HDMI)");
+				break;
+			case VolumeControl.ActiveOutput.BLUETOOTH_HEADPHONES:
+				label = _("Volume (Bluetooth headphones)");
+				break;
+			case VolumeControl.ActiveOutput.USB_HEADPHONES:
+				label = _("Volume (Usb headphones)");
+				break;
+			case VolumeControl.ActiveOutput.HDMI_HEADPHONES:
+				label = _("Volume (HDMI headphones)");
+				break;
+		}
+
+		return label;
+	}
+
 	public void update_volume_slider (VolumeControl.ActiveOutput active_output) {
+		this.set_volume_slider_label (volume_slider_label_for (active_output));
+	}
+
+	public void set_volume_slider_label (string label) {
+		/* Several outputs share a label, switching between them changes nothing */
+		if (label == this.volume_slider_label)
+			return;
+
 		int index = find_action (this.volume_section, "indicator.volume");
 		if (index != -1) {
-			string label = "Volume";
-			switch (active_output) {
-				case VolumeControl.ActiveOutput.SPEAKERS:
-					label = _("Volume");
-					break;
-				case VolumeControl.ActiveOutput.HEADPHONES:
-					label = _("Volume (Headphones)");
-					break;
-				case VolumeControl.ActiveOutput.BLUETOOTH_SPEAKER:
-					label = _("Volume (Bluetooth)");
-					break;
-				case VolumeControl.ActiveOutput.USB_SPEAKER:
-					label = _("Volume (Usb)");
-					break;
-				case VolumeControl.ActiveOutput.HDMI_SPEAKER:
-					label = _("Volume (HDMI)");
-					break;
-				case VolumeControl.ActiveOutput.BLUETOOTH_HEADPHONES:
-					label = _("Volume (Bluetooth headphones)");
-					break;
-				case VolumeControl.ActiveOutput.USB_HEADPHONES:
-					label = _("Volume (Usb headphones)");
-					break;
-				case VolumeControl.ActiveOutput.HDMI_HEADPHONES:
-					label = _("Volume (HDMI headphones)");
-					break;
-			}
-			this.volume_section.remove (index);
-			this.volume_section.insert_item (index, this.create_slider_menu_item (_(label), "indicator.volume(0)", 0.0, 1.0, 0.01,
-																  "audio-volume-low-zero-panel",
-																  "audio-volume-high-panel", true));
+			this.volume_section.replace_item (index, get_volume_slider (label));
+			this.volume_slider_label = label;
 		}
 	}
 
+	/* Volume sliders only differ in their label, so the menus of all profiles
+	 * share one per label */
+	static MenuItem get_volume_slider (string label) {
+		if (volume_sliders == null)
+			volume_sliders = new HashTable<string, MenuItem> (str_hash, str_equal);
+
+		var slider = volume_sliders.lookup (label);
+		if (slider == null) {
+			slider = create_slider_menu_item (label, "indicator.volume(0)", 0.0, 1.0, 0.01,
+											  "audio-volume-low-zero-panel",
+											  "audio-volume-high-panel", true);
+			volume_sliders.insert (label, slider);
+		}
+
+		return slider;
+	}
+
 	public Menu root;
-	public Menu menu;
-	Menu volume_section;
+	public BatchedMenu menu;
+	BatchedMenu volume_section;
+	static HashTable<string, MenuItem>? volume_sliders = null;
+	static MenuItem? mic_slider = null;
+	static MenuItem? high_volume_warning_item = null;
+	string volume_slider_label;
 	bool mic_volume_shown;
 	bool settings_shown = false;
 	bool high_volume_warning_shown = false;
@@ -294,26 +352,37 @@ public class SoundMenu: Object
 	int number_of_running_players = 0;
 	string default_player = "";
 
-	/* returns the position in this.menu of the section that's associated with @player */
-	int find_player_section (MediaPlayer player) {
-		debug("Looking for player: %s", player.id);
-		string action_name = @"indicator.$(player.id)";
-		int n = this.menu.get_n_items ();
-		for (int i = 0; i < n; i++) {
-			var section = this.menu.get_item_link (i, Menu.LINK_SECTION);
-			if (section == null) continue;
+	/* Position in this.menu of each player's section.  The volume section is
+	 * always at position 0, so a lookup that returns 0 means "no section". */
+	HashTable<MediaPlayer, int> player_sections;
 
-			string action;
-			section.get_item_attribute (0, "action", "s", out action);
-			if (action == action_name)
-				return i;
-		}
+	/* Players that aren't running, but whose section shows playback controls */
+	HashTable<MediaPlayer, bool> inactive_player_controls;
 
-		debug("Unable to find section for player: %s", player.id);
-		return -1;
+	/* The playlists shown in a player's "Choose Playlist" submenu, in order */
+	[Compact]
+	class Playlists {
+		public BatchedMenu section = new BatchedMenu ();
+		public GenericArray<string> ids = new GenericArray<string> ();
+		public GenericArray<string> names = new GenericArray<string> ();
+	}
+
+	HashTable<MediaPlayer, Playlists> playlists;
+
+	void track_player_controls (MediaPlayer player, MenuModel player_section) {
+		if (!player.is_running && find_player_playback_controls_section (player_section) != -1)
+			this.inactive_player_controls.insert (player, true);
+		else
+			this.inactive_player_controls.remove (player);
+	}
+
+	/* returns the position in this.menu of the section that's associated with @player */
+	int find_player_section (MediaPlayer player) {
+		int index = this.player_sections.lookup (player);
+		return index != 0 ? index : -1;
 	}
 
-	int find_player_playback_controls_section (Menu player_menu) {
+	int find_player_playback_controls_section (MenuModel player_menu) {
 		int n = player_menu.get_n_items ();
 		for (int i = 0; i < n; i++) {
 			string type;
@@ -327,7 +396,7 @@ public class SoundMenu: Object
 
 	MenuItem create_playback_menu_item (MediaPlayer player) {
 		var playback_item = new MenuItem (null, null);
-		playback_item.set_attribute ("x-canonical-type", "s", PLAYBACK_ITEM_TYPE);
+		playback_item.set_attribute_value ("x-canonical-type", MenuAttributes.for_string (PLAYBACK_ITEM_TYPE));
 		if (player.is_running) {
 			if (player.can_do_play) {
 				playback_item.set_attribute ("x-canonical-play-action", "s", "indicator.play." + player.id);
@@ -350,23 +419,24 @@ public class SoundMenu: Object
 		if (this.hide_players)
 			return;
 
-		var section = new Menu ();
-		Icon icon;
+		var section = new BatchedMenu ();
 
 		debug("Adding section for player: %s (%s)", player.id, player.is_running ? "running" : "not running");
 
-		icon = player.icon;
-		if (icon == null)
-			icon = new ThemedIcon.with_default_fallbacks ("application-default-icon");
+		Variant? icon;
+		if (player.icon != null)
+			icon = MenuAttributes.for_icon (player.icon);
+		else
+			icon = MenuAttributes.for_themed_icon ("application-default-icon");
 
 		var base_action = "indicator." + player.id;
 		if (this.greeter_players)
 			base_action += ".greeter";
 
 		var player_item = new MenuItem (player.name, base_action);
-		player_item.set_attribute ("x-canonical-type", "s", "com.canonical.unity.media-player");
+		player_item.set_attribute_value ("x-canonical-type", MenuAttributes.for_string ("com.canonical.unity.media-player"));
 		if (icon != null)
-			player_item.set_attribute_value ("icon", icon.serialize ());
+			player_item.set_attribute_value ("icon", icon);
 		section.append_item (player_item);
 
 		if (player.is_running|| !this.hide_inactive_player_controls || player.id == this.default_player) {
@@ -375,11 +445,13 @@ public class SoundMenu: Object
 		}
 
 		/* Add new players to the end of the player sections, just before the settings */
-		if (settings_shown) {
-			this.menu.insert_section (this.menu.get_n_items () -1, null, section);
-		} else {
-			this.menu.append_section (null, section);
-		}
+		int index = this.menu.get_n_items ();
+		if (settings_shown)
+			index--;
+
+		this.menu.insert_section (index, null, section);
+		this.player_sections.insert (player, index);
+		track_player_controls (player, section);
 	}
 
 	void remove_player_section (MediaPlayer player) {
@@ -387,12 +459,26 @@ public class SoundMenu: Object
 			return;
 
 		int index = this.find_player_section (player);
-		if (index >= 0)
-			this.menu.remove (index);
+		if (index < 0)
+			return;
+
+		this.menu.remove (index);
+		this.player_sections.remove (player);
+		this.inactive_player_controls.remove (player);
+		this.playlists.remove (player);
+
+		/* the sections after it moved up */
+		var iter = HashTableIter<MediaPlayer, int> (this.player_sections);
+		MediaPlayer other;
+		int other_index;
+		while (iter.next (out other, out other_index)) {
+			if (other_index > index)
+				iter.replace (other_index - 1);
+		}
 	}
 
 	void add_player_playback_controls (MediaPlayer player, int index, bool adding_default_player) {
-		var player_section = this.menu.get_item_link(index, Menu.LINK_SECTION) as Menu;
+		var player_section = this.menu.get_item_link(index, Menu.LINK_SECTION) as BatchedMenu;
 
 		int play_control_index = find_player_playback_controls_section (player_section);
 		if (player.is_running || !this.hide_inactive_player_controls || (number_of_running_players == 0 && adding_default_player) ) {
@@ -404,10 +490,14 @@ public class SoundMenu: Object
 		} else {
 			if (play_control_index != -1 && number_of_running_players >= 1) {
 				// remove both, playlist and play controls
-				player_section.remove (PlayerSectionPosition.PLAYLIST);
+				if (player_section.get_n_items () > PlayerSectionPosition.PLAYLIST)
+					player_section.remove (PlayerSectionPosition.PLAYLIST);
+				this.playlists.remove (player);
 				player_section.remove (PlayerSectionPosition.PLAYER_CONTROLS);	
 			}
 		}	
+
+		track_player_controls (player, player_section);
 	}
 
 	void update_player_section (MediaPlayer player, int index) {
@@ -419,52 +509,114 @@ public class SoundMenu: Object
 		if (index < 0)
 			return;
 
-		var player_section = this.menu.get_item_link (index, Menu.LINK_SECTION) as Menu;
-
-		/* if a section has three items, the playlists menu is in it */
-		if (player_section.get_n_items () == 3)
-			player_section.remove (2);
+		var player_section = this.menu.get_item_link (index, Menu.LINK_SECTION) as BatchedMenu;
 
-		if (!player.is_running)
+		/* the submenu is only kept while the player is running and has playlists */
+		if (!player.is_running || player.get_n_playlists () == 0) {
+			if (player_section.get_n_items () > PlayerSectionPosition.PLAYLIST)
+				player_section.remove (PlayerSectionPosition.PLAYLIST);
+			this.playlists.remove (player);
 			return;
+		}
 
-		var count = player.get_n_playlists ();
-		if (count == 0)
+		unowned Playlists? shown = this.playlists.lookup (player);
+		if (shown != null && player_section.get_n_items () > PlayerSectionPosition.PLAYLIST) {
+			update_playlists_section (player, shown);
 			return;
+		}
 
-		var playlists_section = new Menu ();
+		var new_playlists = new Playlists ();
+		update_playlists_section (player, new_playlists);
+
+		var submenu = new Menu ();
+		submenu.append_section (null, new_playlists.section);
+		if (player_section.get_n_items () > PlayerSectionPosition.PLAYLIST)
+			player_section.replace_item (PlayerSectionPosition.PLAYLIST, new MenuItem.submenu (_("Choose Playlist"), submenu));
+		else
+			player_section.append_submenu (_("Choose Playlist"), submenu);
+
+		this.playlists.insert (player, (owned) new_playlists);
+	}
+
+	/* Brings @shown in line with the player's playlists, matching them by id.
+	 * Unchanged playlists are left alone, so that renaming, adding or removing
+	 * a single playlist is a single change to the exported submenu. */
+	void update_playlists_section (MediaPlayer player, Playlists shown) {
+		var count = player.get_n_playlists ();
+		var ids = new string[count];
+		var wanted = new HashTable<unowned string, bool> (str_hash, str_equal);
 		for (int i = 0; i < count; i++) {
-			var playlist_id = player.get_playlist_id (i);
-			playlists_section.append (player.get_playlist_name (i),
-									  @"indicator.play-playlist.$(player.id)::$playlist_id");
+			ids[i] = player.get_playlist_id (i);
+			wanted.insert (ids[i], true);
+		}
 
+		/* drop the playlists that are gone, @present has the ones that are
+		 * left and haven't been matched yet */
+		var present = new HashTable<unowned string, bool> (str_hash, str_equal);
+		for (int i = (int) shown.ids.length - 1; i >= 0; i--) {
+			if (wanted.contains (shown.ids[i]) && !present.contains (shown.ids[i])) {
+				present.insert (shown.ids[i], true);
+			} else {
+				shown.section.remove (i);
+				shown.ids.remove_index (i);
+				shown.names.remove_index (i);
+			}
 		}
 
-		var submenu = new Menu ();
-		submenu.append_section (null, playlists_section);
-		player_section.append_submenu (_("Choose Playlist"), submenu);
+		for (int i = 0; i < count; i++) {
+			if (i < shown.ids.length && shown.ids[i] == ids[i]) {
+				present.remove (ids[i]);
+				var name = player.get_playlist_name (i);
+				if (shown.names[i] != name) {
+					shown.section.replace_item (i, create_playlist_menu_item (player, ids[i], name));
+					shown.names[i] = name;
+				}
+			} else if (!present.contains (ids[i])) {
+				var name = player.get_playlist_name (i);
+				shown.section.insert_item (i, create_playlist_menu_item (player, ids[i], name));
+				shown.ids.insert (i, ids[i]);
+				shown.names.insert (i, name);
+			} else {
+				/* a playlist that moved: take out the one in its way, it is
+				 * put back when its own position comes up */
+				present.remove (shown.ids[i]);
+				shown.section.remove (i);
+				shown.ids.remove_index (i);
+				shown.names.remove_index (i);
+				i--;
+			}
+		}
+	}
+
+	MenuItem create_playlist_menu_item (MediaPlayer player, string id, string name) {
+		return new MenuItem (name, @"indicator.play-playlist.$(player.id)::$id");
 	}
 	
+	void player_playlists_changed (MediaPlayer player) {
+		BatchedMenu.begin ();
+		update_playlists (player);
+		BatchedMenu.commit ();
+	}
+
 	void update_playbackstatus (MediaPlayer player) {
 		int index = find_player_section (player);
 		if (index != -1) {
+			BatchedMenu.begin ();
 			update_player_section (player, index);	
+			BatchedMenu.commit ();
 		}
 	}
 
-	MenuItem create_slider_menu_item (string label, string action, double min, double max, double step, string min_icon_name, string max_icon_name, bool sync_action) {
-		var min_icon = new ThemedIcon.with_default_fallbacks (min_icon_name);
-		var max_icon = new ThemedIcon.with_default_fallbacks (max_icon_name);
-
+	static MenuItem create_slider_menu_item (string label, string action, double min, double max, double step, string min_icon_name, string max_icon_name, bool sync_action) {
 		var slider = new MenuItem (label, action);
-		slider.set_attribute ("x-canonical-type", "s", "com.canonical.unity.slider");
-		slider.set_attribute_value ("min-icon", min_icon.serialize ());
-		slider.set_attribute_value ("max-icon", max_icon.serialize ());
-		slider.set_attribute ("min-value", "d", min);
-		slider.set_attribute ("max-value", "d", max);
-		slider.set_attribute ("step", "d", step);
+		slider.set_attribute_value ("x-canonical-type", MenuAttributes.for_string ("com.canonical.unity.slider"));
+		slider.set_attribute_value ("min-icon", MenuAttributes.for_themed_icon (min_icon_name));
+		slider.set_attribute_value ("max-icon", MenuAttributes.for_themed_icon (max_icon_name));
+		slider.set_attribute_value ("min-value", MenuAttributes.for_double (min));
+		slider.set_attribute_value ("max-value", MenuAttributes.for_double (max));
+		slider.set_attribute_value ("step", MenuAttributes.for_double (step));
 		if (sync_action) {
-			slider.set_attribute ("x-canonical-sync-action", "s", "indicator.volume-sync");
+			slider.set_attribute_value ("x-canonical-sync-action", MenuAttributes.for_string ("indicator.volume-sync"));
 		}
 
 		return slider;
@@ -0,0 +1,181 @@
+/*
+ * Copyright 2016 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+#include <gio/gio.h>
+#include <libdbustest/dbus-test.h>
+
+extern "C" {
+#include "indicator-sound-service.h"
+#include "vala-mocks.h"
+}
+
+class AccountsServiceAccessTest : public ::testing::Test
+{
+
+	protected:
+		DbusTestService * service = NULL;
+		DbusTestDbusMock * accounts = NULL;
+		DbusTestDbusMock * greeter = NULL;
+		DbusTestDbusMockObject * greeterlist = NULL;
+
+		GDBusConnection * session = NULL;
+		GDBusConnection * system = NULL;
+
+		virtual void SetUp() {
+			g_setenv("XDG_SESSION_CLASS", "greeter", TRUE);
+
+			service = dbus_test_service_new(NULL);
+			dbus_test_service_set_bus(service, DBUS_TEST_SERVICE_BUS_BOTH);
+
+			/* Accounts Service with a sound object for each user. Block
+			   keeps it busy, so that calls to it stay in flight */
+			accounts = dbus_test_dbus_mock_new("org.freedesktop.Accounts");
+			dbus_test_task_set_bus(DBUS_TEST_TASK(accounts), DBUS_TEST_SERVICE_BUS_SYSTEM);
+
+			DbusTestDbusMockObject * baseobj = dbus_test_dbus_mock_get_object(accounts, "/org/freedesktop/Accounts", "org.freedesktop.Accounts", NULL);
+			dbus_test_dbus_mock_object_add_method(accounts, baseobj,
+				"FindUserByName", G_VARIANT_TYPE_STRING, G_VARIANT_TYPE_OBJECT_PATH,
+				"ret = dbus.ObjectPath('/user/' + args[0])\n", NULL);
+			dbus_test_dbus_mock_object_add_method(accounts, baseobj,
+				"Block", NULL, NULL,
+				"import time\ntime.sleep(0.5)\n", NULL);
+
+			for (auto user : { "alice", "bob" }) {
+				gchar * path = g_strdup_printf("/user/%s", user);
+				DbusTestDbusMockObject * soundobj = dbus_test_dbus_mock_get_object(accounts, path, "com.ubuntu.AccountsService.Sound", NULL);
+				dbus_test_dbus_mock_object_add_property(accounts, soundobj,
+					"Volume", G_VARIANT_TYPE_DOUBLE,
+					g_variant_new_double(0.5), NULL);
+				dbus_test_dbus_mock_object_add_property(accounts, soundobj,
+					"Muted", G_VARIANT_TYPE_BOOLEAN,
+					g_variant_new_boolean(FALSE), NULL);
+				dbus_test_dbus_mock_object_add_property(accounts, soundobj,
+					"LastRunningPlayer", G_VARIANT_TYPE_STRING,
+					g_variant_new_string(""), NULL);
+				g_free(path);
+			}
+
+			/* The greeter, with alice selected */
+			greeter = dbus_test_dbus_mock_new("com.canonical.UnityGreeter");
+			dbus_test_task_set_bus(DBUS_TEST_TASK(greeter), DBUS_TEST_SERVICE_BUS_SESSION);
+
+			greeterlist = dbus_test_dbus_mock_get_object(greeter, "/list", "com.canonical.UnityGreeter.List", NULL);
+			dbus_test_dbus_mock_object_add_method(greeter, greeterlist,
+				"GetActiveEntry", NULL, G_VARIANT_TYPE_STRING,
+				"ret = 'alice'\n", NULL);
+
+			dbus_test_service_add_task(service, DBUS_TEST_TASK(accounts));
+			dbus_test_service_add_task(service, DBUS_TEST_TASK(greeter));
+			dbus_test_service_start_tasks(service);
+
+			session = g_bus_get_sync(G_BUS_TYPE_SESSION, NULL, NULL);
+			ASSERT_NE(nullptr, session);
+			g_dbus_connection_set_exit_on_close(session, FALSE);
+
+			system = g_bus_get_sync(G_BUS_TYPE_SYSTEM, NULL, NULL);
+			ASSERT_NE(nullptr, system);
+			g_dbus_connection_set_exit_on_close(system, FALSE);
+		}
+
+		virtual void TearDown() {
+			g_clear_object(&accounts);
+			g_clear_object(&greeter);
+			g_clear_object(&service);
+
+			g_object_unref(session);
+			g_object_unref(system);
+
+			g_unsetenv("XDG_SESSION_CLASS");
+		}
+
+		static gboolean timeout_cb (gpointer user_data) {
+			GMainLoop * loop = static_cast<GMainLoop *>(user_data);
+			g_main_loop_quit(loop);
+			return G_SOURCE_REMOVE;
+		}
+
+		void loop (unsigned int ms) {
+			GMainLoop * loop = g_main_loop_new(NULL, FALSE);
+			g_timeout_add(ms, timeout_cb, loop);
+			g_main_loop_run(loop);
+			g_main_loop_unref(loop);
+		}
+
+		void select_user (const gchar * user) {
+			dbus_test_dbus_mock_object_emit_signal(greeter, greeterlist,
+				"EntrySelected", G_VARIANT_TYPE("(s)"),
+				g_variant_new("(s)", user), NULL);
+		}
+
+		double get_volume (const gchar * user) {
+			gchar * path = g_strdup_printf("/user/%s", user);
+			GVariant * propval = g_dbus_connection_call_sync(system,
+				"org.freedesktop.Accounts",
+				path,
+				"org.freedesktop.DBus.Properties",
+				"Get",
+				g_variant_new("(ss)", "com.ubuntu.AccountsService.Sound", "Volume"),
+				G_VARIANT_TYPE("(v)"),
+				G_DBUS_CALL_FLAGS_NONE,
+				-1, NULL, NULL);
+			g_free(path);
+
+			if (propval == nullptr)
+				return -1.0;
+
+			GVariant * value = NULL;
+			g_variant_get(propval, "(v)", &value);
+			double volume = g_variant_get_double(value);
+			g_variant_unref(value);
+			g_variant_unref(propval);
+
+			return volume;
+		}
+};
+
+TEST_F(AccountsServiceAccessTest, SwitchUserWhileWriting) {
+	AccountsServiceAccess * access = accounts_service_access_new();
+	loop(500);
+
+	/* Select bob once, so that switching back to him is immediate */
+	select_user("bob");
+	loop(500);
+	select_user("alice");
+	loop(500);
+
+	/* The first write is held up behind Block, the second one queues
+	   behind it, and then bob gets selected */
+	g_dbus_connection_call(system,
+		"org.freedesktop.Accounts",
+		"/org/freedesktop/Accounts",
+		"org.freedesktop.Accounts",
+		"Block",
+		NULL, NULL,
+		G_DBUS_CALL_FLAGS_NONE,
+		-1, NULL, NULL, NULL);
+	g_object_set(access, "volume", 0.1, NULL);
+	g_object_set(access, "volume", 0.2, NULL);
+	select_user("bob");
+	loop(1500);
+
+	/* What was written for alice never reaches bob */
+	EXPECT_EQ(0.5, get_volume("bob"));
+	EXPECT_NE(0.2, get_volume("alice"));
+	EXPECT_EQ(0.5, accounts_service_access_get_volume(access));
+
+	g_object_unref(access);
+}
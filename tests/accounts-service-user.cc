@@ -198,3 +198,59 @@ TEST_F(AccountsServiceUserTest, SetMediaPlayer) {
 	g_object_unref(media);
 	g_object_unref(srv);
 }
+
+TEST_F(AccountsServiceUserTest, CoalescedTrackChanges) {
+	MediaPlayerTrack * track = media_player_track_new("Artist", "Title", "Album", "http://art.url");
+
+	MediaPlayerMock * media = MEDIA_PLAYER_MOCK(
+		g_object_new(TYPE_MEDIA_PLAYER_MOCK,
+			"mock-id", "player-id",
+			"mock-name", "Test Player",
+			"mock-state", "Playing",
+			"mock-is-running", TRUE,
+			"mock-can-raise", FALSE,
+			"mock-current-track", track,
+			NULL)
+	);
+	g_clear_object(&track);
+
+	AccountsServiceUser * srv = accounts_service_user_new();
+
+	accounts_service_user_set_player(srv, MEDIA_PLAYER(media));
+
+	loop(500);
+
+	EXPECT_STREQ("Title", get_property_string("Title"));
+
+	/* Setting the same player again writes nothing */
+	gint64 writes = indicator_sound_debug_metrics_get_value("accounts-service-writes");
+	accounts_service_user_set_player(srv, MEDIA_PLAYER(media));
+
+	loop(500);
+
+	EXPECT_EQ(writes, indicator_sound_debug_metrics_get_value("accounts-service-writes"));
+
+	/* Skip through a playlist */
+	for (int i = 0; i < 20; i++) {
+		gchar * title = g_strdup_printf("Title %d", i);
+		track = media_player_track_new("Artist-ish", title, "Psuedo Album", "http://fake.art.url");
+		media_player_mock_set_mock_current_track(media, track);
+		g_clear_object(&track);
+		g_free(title);
+
+		accounts_service_user_set_player(srv, MEDIA_PLAYER(media));
+	}
+
+	loop(500);
+
+	/* Only the last track is written, and only the fields that changed plus the timestamp */
+	EXPECT_STREQ("Title 19", get_property_string("Title"));
+	EXPECT_STREQ("Artist-ish", get_property_string("Artist"));
+	EXPECT_STREQ("Psuedo Album", get_property_string("Album"));
+	EXPECT_STREQ("http://fake.art.url", get_property_string("ArtUrl"));
+	EXPECT_STREQ("Playing", get_property_string("State"));
+	EXPECT_EQ(writes + 5, indicator_sound_debug_metrics_get_value("accounts-service-writes"));
+
+	g_object_unref(media);
+	g_object_unref(srv);
+}
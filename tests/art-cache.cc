@@ -0,0 +1,191 @@
+/*
+ * Copyright 2016 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+
+#include <gtest/gtest.h>
+#include <gio/gio.h>
+#include <gdk-pixbuf/gdk-pixbuf.h>
+
+extern "C" {
+#include "indicator-sound-service.h"
+}
+
+class ArtCacheTest : public ::testing::Test
+{
+	protected:
+		gchar * tmpdir = NULL;
+		gchar * cachedir = NULL;
+		ArtCache * cache = NULL;
+		int ready = 0;
+
+		virtual void SetUp() {
+			tmpdir = g_dir_make_tmp("art-cache-test-XXXXXX", NULL);
+			ASSERT_NE(nullptr, tmpdir);
+			cachedir = g_build_filename(tmpdir, "cache", NULL);
+
+			cache = art_cache_new(cachedir);
+			g_signal_connect(cache, "thumbnail-ready", G_CALLBACK(thumbnail_ready_cb), &ready);
+		}
+
+		virtual void TearDown() {
+			g_clear_object(&cache);
+
+			gchar * cmd = g_strdup_printf("rm -rf '%s'", tmpdir);
+			g_spawn_command_line_sync(cmd, NULL, NULL, NULL, NULL);
+			g_free(cmd);
+
+			g_free(cachedir);
+			g_free(tmpdir);
+		}
+
+		static void thumbnail_ready_cb (ArtCache * cache, const gchar * art_url, gpointer user_data) {
+			(*static_cast<int *>(user_data))++;
+		}
+
+		static gboolean timeout_cb (gpointer user_data) {
+			GMainLoop * loop = static_cast<GMainLoop *>(user_data);
+			g_main_loop_quit(loop);
+			return G_SOURCE_REMOVE;
+		}
+
+		void loop (unsigned int ms) {
+			GMainLoop * loop = g_main_loop_new(NULL, FALSE);
+			g_timeout_add(ms, timeout_cb, loop);
+			g_main_loop_run(loop);
+			g_main_loop_unref(loop);
+		}
+
+		/* Loops until @count thumbnails are ready, or a few seconds have passed */
+		void wait_for_ready (int count) {
+			for (int i = 0; i < 50 && ready < count; i++)
+				loop(100);
+		}
+
+		/* Writes a @size by @size PNG named @name and returns its url */
+		std::string create_image (const gchar * name, int size) {
+			GdkPixbuf * pixbuf = gdk_pixbuf_new(GDK_COLORSPACE_RGB, FALSE, 8, size, size);
+			gdk_pixbuf_fill(pixbuf, 0x336699ff);
+
+			gchar * path = g_build_filename(tmpdir, name, NULL);
+			EXPECT_TRUE(gdk_pixbuf_save(pixbuf, path, "png", NULL, NULL));
+			gchar * uri = g_filename_to_uri(path, NULL, NULL);
+			std::string url(uri);
+
+			g_free(uri);
+			g_free(path);
+			g_object_unref(pixbuf);
+			return url;
+		}
+
+		/* Checks that @url is a thumbnail in the cache directory */
+		void expect_thumbnail (const std::string& url) {
+			gchar * path = g_filename_from_uri(url.c_str(), NULL, NULL);
+			ASSERT_NE(nullptr, path);
+			EXPECT_TRUE(g_str_has_prefix(path, cachedir));
+
+			GdkPixbuf * pixbuf = gdk_pixbuf_new_from_file(path, NULL);
+			ASSERT_NE(nullptr, pixbuf);
+			EXPECT_GE(128, gdk_pixbuf_get_width(pixbuf));
+			EXPECT_GE(128, gdk_pixbuf_get_height(pixbuf));
+
+			g_object_unref(pixbuf);
+			g_free(path);
+		}
+
+		std::string lookup (const std::string& art_url) {
+			gchar * url = art_cache_lookup(cache, art_url.c_str());
+			std::string ret(url);
+			g_free(url);
+			return ret;
+		}
+};
+
+TEST_F(ArtCacheTest, CacheHit) {
+	auto art = create_image("cover.png", 512);
+
+	/* The original is used until the thumbnail is ready */
+	EXPECT_EQ(art, lookup(art));
+	wait_for_ready(1);
+	ASSERT_EQ(1, ready);
+
+	auto thumbnail = lookup(art);
+	EXPECT_NE(art, thumbnail);
+	expect_thumbnail(thumbnail);
+
+	/* Later lookups are answered from the cache */
+	EXPECT_EQ(thumbnail, lookup(art));
+	loop(200);
+	EXPECT_EQ(1, ready);
+
+	/* And so are those of another cache, from the thumbnail on disk */
+	ArtCache * other = art_cache_new(cachedir);
+	art_cache_lookup(other, art.c_str());
+	loop(500);
+	gchar * url = art_cache_lookup(other, art.c_str());
+	EXPECT_EQ(thumbnail, url);
+	g_free(url);
+	g_object_unref(other);
+}
+
+TEST_F(ArtCacheTest, ConcurrentSameImage) {
+	/* Equal images share a thumbnail, and are generated at the same time */
+	auto art1 = create_image("cover1.png", 512);
+	auto art2 = create_image("cover2.png", 512);
+
+	lookup(art1);
+	lookup(art2);
+	wait_for_ready(2);
+	ASSERT_EQ(2, ready);
+
+	auto thumbnail = lookup(art1);
+	EXPECT_EQ(thumbnail, lookup(art2));
+	expect_thumbnail(thumbnail);
+
+	/* No temporary files are left behind */
+	GDir * dir = g_dir_open(cachedir, 0, NULL);
+	ASSERT_NE(nullptr, dir);
+	int n_files = 0;
+	while (g_dir_read_name(dir) != NULL)
+		n_files++;
+	g_dir_close(dir);
+	EXPECT_EQ(1, n_files);
+}
+
+TEST_F(ArtCacheTest, UnreadableSource) {
+	gchar * path = g_build_filename(tmpdir, "missing.png", NULL);
+	gchar * uri = g_filename_to_uri(path, NULL, NULL);
+	std::string missing(uri);
+	g_free(uri);
+	g_free(path);
+
+	/* Failures leave the url as it is, and aren't retried */
+	EXPECT_EQ(missing, lookup(missing));
+	wait_for_ready(1);
+	ASSERT_EQ(1, ready);
+	EXPECT_EQ(missing, lookup(missing));
+	loop(200);
+	EXPECT_EQ(1, ready);
+
+	/* Broken data urls are withheld */
+	EXPECT_EQ("", lookup("data:image/png;base64,bm90IGFuIGltYWdl"));
+	wait_for_ready(2);
+	ASSERT_EQ(2, ready);
+	EXPECT_EQ("", lookup("data:image/png;base64,bm90IGFuIGltYWdl"));
+
+	/* Remote art isn't cached at all */
+	EXPECT_EQ("http://example.com/cover.png", lookup("http://example.com/cover.png"));
+}
@@ -0,0 +1,215 @@
+/*
+ * Copyright 2016 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include <gtest/gtest.h>
+#include <gio/gio.h>
+
+#include <unity/gmenuharness/MatchResult.h>
+#include <unity/gmenuharness/MatchUtils.h>
+#include <unity/gmenuharness/MenuItemMatcher.h>
+
+using namespace std;
+using namespace unity::gmenuharness;
+
+class GMenuHarnessTest : public ::testing::Test
+{
+    protected:
+        static const int n_items = 200;
+        static const int n_actions = 20;
+
+        shared_ptr<GMenuModel> menu;
+        map<string, shared_ptr<GActionGroup>> actions;
+
+        /* A section of @n_items sliders, each with its own action and the shared
+         * volume action as a pass-through attribute, like the sound menu's */
+        virtual void SetUp() {
+            GSimpleActionGroup * group = g_simple_action_group_new();
+            for (int i = 0; i < n_actions; i++) {
+                string name = "slider" + to_string(i);
+                GSimpleAction * action = g_simple_action_new_stateful(name.c_str(), nullptr, g_variant_new_double(i / 100.0));
+                g_action_map_add_action(G_ACTION_MAP(group), G_ACTION(action));
+                g_object_unref(action);
+            }
+            GSimpleAction * volume = g_simple_action_new_stateful("volume", nullptr, g_variant_new_double(0.5));
+            g_action_map_add_action(G_ACTION_MAP(group), G_ACTION(volume));
+            g_object_unref(volume);
+            actions["indicator"] = shared_ptr<GActionGroup>(G_ACTION_GROUP(group), &g_object_deleter);
+
+            GMenu * section = g_menu_new();
+            for (int i = 0; i < n_items; i++) {
+                string action = "indicator.slider" + to_string(i % n_actions);
+                GMenuItem * item = g_menu_item_new(("Slider " + to_string(i)).c_str(), action.c_str());
+                g_menu_item_set_attribute(item, "x-canonical-sync-action", "s", "indicator.volume");
+                g_menu_append_item(section, item);
+                g_object_unref(item);
+            }
+
+            GMenu * root = g_menu_new();
+            g_menu_append_section(root, nullptr, G_MENU_MODEL(section));
+            g_object_unref(section);
+            menu = shared_ptr<GMenuModel>(G_MENU_MODEL(root), &g_object_deleter);
+        }
+
+        virtual void TearDown() {
+            actions.clear();
+            menu.reset();
+        }
+
+        MenuItemMatcher sectionMatcher(double volume) {
+            MenuItemMatcher matcher;
+            matcher.section();
+            for (int i = 0; i < n_items; i++) {
+                matcher.item(MenuItemMatcher()
+                    .label("Slider " + to_string(i))
+                    .action("indicator.slider" + to_string(i % n_actions))
+                    .pass_through_double_attribute("x-canonical-sync-action", volume)
+                );
+            }
+            return matcher;
+        }
+};
+
+TEST_F(GMenuHarnessTest, ActionStateSnapshotBenchmark) {
+    const int n_passes = 100;
+    auto matcher = sectionMatcher(0.5);
+
+    gint64 start = g_get_monotonic_time();
+    for (int i = 0; i < n_passes; i++) {
+        MatchResult result;
+        matcher.match(result, {}, menu, actions, 0);
+        ASSERT_TRUE(result.success()) << result.concat_failures();
+    }
+    g_print("%d matches of a %d item menu in %" G_GINT64_FORMAT " ms\n", n_passes, n_items,
+            (g_get_monotonic_time() - start) / 1000);
+}
+
+TEST_F(GMenuHarnessTest, ActionStateSnapshotFollowsChanges) {
+    auto group = actions["indicator"];
+
+    auto state = actionGroupGetState(group, "volume");
+    ASSERT_NE(nullptr, state);
+    EXPECT_EQ(0.5, g_variant_get_double(state.get()));
+
+    g_action_group_change_action_state(group.get(), "volume", g_variant_new_double(0.25));
+    state = actionGroupGetState(group, "volume");
+    ASSERT_NE(nullptr, state);
+    EXPECT_EQ(0.25, g_variant_get_double(state.get()));
+
+    MatchResult result;
+    sectionMatcher(0.25).match(result, {}, menu, actions, 0);
+    EXPECT_TRUE(result.success()) << result.concat_failures();
+
+    /* Added and removed actions are seen too */
+    EXPECT_EQ(nullptr, actionGroupGetState(group, "extra"));
+    GSimpleAction * extra = g_simple_action_new_stateful("extra", nullptr, g_variant_new_boolean(TRUE));
+    g_action_map_add_action(G_ACTION_MAP(group.get()), G_ACTION(extra));
+    g_object_unref(extra);
+    EXPECT_NE(nullptr, actionGroupGetState(group, "extra"));
+
+    g_action_map_remove_action(G_ACTION_MAP(group.get()), "extra");
+    EXPECT_EQ(nullptr, actionGroupGetState(group, "extra"));
+}
+
+/* A chain of @depth nested sections, each with a plain item and the next section */
+static shared_ptr<GMenuModel>
+create_deep_menu (int depth)
+{
+    GMenu * menu = g_menu_new();
+    g_menu_append(menu, ("Level " + to_string(depth)).c_str(), nullptr);
+    if (depth > 0) {
+        auto section = create_deep_menu(depth - 1);
+        g_menu_append_section(menu, nullptr, section.get());
+    }
+    return shared_ptr<GMenuModel>(G_MENU_MODEL(menu), &g_object_deleter);
+}
+
+static MenuItemMatcher
+create_deep_matcher (int depth)
+{
+    MenuItemMatcher matcher;
+    matcher.section();
+    matcher.item(MenuItemMatcher().label("Level " + to_string(depth)));
+    if (depth > 0)
+        matcher.item(create_deep_matcher(depth - 1));
+    return matcher;
+}
+
+TEST_F(GMenuHarnessTest, DeepMatchBenchmark) {
+    const int depth = 8;
+    const int n_matches = 10000;
+
+    GMenu * root = g_menu_new();
+    auto deep = create_deep_menu(depth);
+    g_menu_append_section(root, nullptr, deep.get());
+    shared_ptr<GMenuModel> root_menu(G_MENU_MODEL(root), &g_object_deleter);
+
+    auto matcher = create_deep_matcher(depth);
+
+    gint64 start = g_get_monotonic_time();
+    for (int i = 0; i < n_matches; i++) {
+        MatchResult result;
+        matcher.match(result, {}, root_menu, actions, 0);
+        ASSERT_TRUE(result.success()) << result.concat_failures();
+    }
+    g_print("%d matches of a menu %d sections deep in %" G_GINT64_FORMAT " ms\n", n_matches, depth,
+            (g_get_monotonic_time() - start) / 1000);
+
+    /* Failures are listed by location, which is printed once */
+    MatchResult result;
+    EXPECT_EQ("Failed expectations:\n", result.concat_failures());
+    result.failure({0, 2}, "first");
+    result.failure({0}, 1, "second");
+    result.failure({0, 2}, "third");
+    EXPECT_FALSE(result.success());
+    EXPECT_EQ("Failed expectations:\n 0 1 second\n 0 2 first\n     third\n", result.concat_failures());
+
+    MatchResult parent;
+    parent.merge(result);
+    EXPECT_FALSE(parent.success());
+    EXPECT_EQ(result.concat_failures(), parent.concat_failures());
+}
+
+TEST_F(GMenuHarnessTest, ActionRecorder) {
+    auto group = actions["indicator"];
+    auto matcher = sectionMatcher(0.5);
+
+    ActionRecorder outer;
+    {
+        /* A match depends on the actions whose state it read */
+        ActionRecorder recorder;
+        MatchResult result;
+        matcher.match(result, {}, menu, actions, 0);
+        EXPECT_TRUE(result.success()) << result.concat_failures();
+
+        EXPECT_EQ(size_t(n_actions + 1), recorder.read().size());
+        EXPECT_EQ(1u, recorder.read().count(ActionRecorder::Action(group.get(), "volume")));
+        EXPECT_EQ(1u, recorder.read().count(ActionRecorder::Action(group.get(), "slider0")));
+        EXPECT_TRUE(recorder.changed().empty());
+
+        /* Missing actions are recorded too */
+        actionGroupGetState(group, "extra");
+        EXPECT_EQ(1u, recorder.read().count(ActionRecorder::Action(group.get(), "extra")));
+    }
+
+    /* Only the innermost recorder records */
+    EXPECT_TRUE(outer.read().empty());
+    actionGroupGetState(group, "volume");
+    EXPECT_EQ(1u, outer.read().size());
+}
@@ -190,17 +190,24 @@ bool IndicatorSoundTestBase::runProcess(QProcess& proc)
     return proc.exitCode() == 0;
 }
 
-bool IndicatorSoundTestBase::startTestMprisPlayer(QString const& playerName)
+bool IndicatorSoundTestBase::startTestMprisPlayer(QString const& playerName, QString const& instanceName)
 {
-    if (!stopTestMprisPlayer(playerName))
+    QStringList arguments = QStringList() << playerName;
+    QString name = playerName;
+    if (!instanceName.isEmpty())
+    {
+        arguments << instanceName;
+        name += "." + instanceName;
+    }
+
+    if (!stopTestMprisPlayer(name))
     {
         return false;
     }
     TestPlayer player;
-    player.name = playerName;
+    player.name = name;
     player.process.reset(new QProcess());
-    player.process->start(MEDIA_PLAYER_MPRIS_BIN, QStringList()
-                                        << playerName);
+    player.process->start(MEDIA_PLAYER_MPRIS_BIN, arguments);
     if (!player.process->waitForStarted())
     {
         qWarning() << "ERROR STARTING PLAYER " << playerName;
@@ -258,6 +265,40 @@ bool IndicatorSoundTestBase::setTestMprisPlayerProperty(QString const &testPlaye
     return setProperty.exitCode() == 0;
 }
 
+bool IndicatorSoundTestBase::setTestMprisPlayerPlaylistCount(QString const &testPlayer, uint count)
+{
+    QProcess setProperty;
+
+    setProperty.start(MEDIA_PLAYER_MPRIS_UPDATE_BIN, QStringList()
+                                        << testPlayer
+                                        << "PlaylistCount"
+                                        << QString::number(count));
+    if (!setProperty.waitForStarted())
+        return false;
+
+    if (!setProperty.waitForFinished())
+        return false;
+
+    return setProperty.exitCode() == 0;
+}
+
+bool IndicatorSoundTestBase::runTestMprisPlayerChurn(QString const &testPlayer, int namesPerSecond, int seconds)
+{
+    QProcess churn;
+    churn.setProcessChannelMode(QProcess::ForwardedChannels);
+    churn.start(MEDIA_PLAYER_MPRIS_CHURN_BIN, QStringList()
+                                        << testPlayer
+                                        << QString::number(namesPerSecond)
+                                        << QString::number(seconds));
+    if (!churn.waitForStarted())
+        return false;
+
+    if (!churn.waitForFinished((seconds + 30) * 1000))
+        return false;
+
+    return churn.exitCode() == 0;
+}
+
 bool IndicatorSoundTestBase::startTestSound(QString const &role)
 {
     testSoundProcess.terminate();
@@ -80,12 +80,16 @@ protected:
     bool resetAllowAmplifiedVolume();
     bool runProcess(QProcess&);
 
-    bool startTestMprisPlayer(QString const& playerName);
+    bool startTestMprisPlayer(QString const& playerName, QString const& instanceName = QString());
     bool stopTestMprisPlayer(QString const& playerName);
     int findRunningTestMprisPlayer(QString const& playerName);
 
     bool setTestMprisPlayerProperty(QString const &testPlayer, QString const &property, bool value);
 
+    bool setTestMprisPlayerPlaylistCount(QString const &testPlayer, uint count);
+
+    bool runTestMprisPlayerChurn(QString const &testPlayer, int namesPerSecond, int seconds);
+
     bool setStreamRestoreVolume(QString const &role, double volume);
 
     bool setSinkVolume(double volume);
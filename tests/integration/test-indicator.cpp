@@ -1387,6 +1387,402 @@ TEST_F(TestIndicator, DesktopMprisPlayerButtonsState)
         ).match());
 }
 
+TEST_F(TestIndicator, DesktopMprisPlayerPlaylists)
+{
+    double INITIAL_VOLUME = 0.0;
+
+    ASSERT_NO_THROW(startAccountsService());
+    EXPECT_TRUE(clearGSettingsPlayers());
+    ASSERT_NO_THROW(startPulseDesktop());
+
+    // initialize volumes in pulseaudio
+    EXPECT_FALSE(setStreamRestoreVolume("alert", INITIAL_VOLUME));
+    EXPECT_TRUE(setSinkVolume(INITIAL_VOLUME));
+
+    // start the test player
+    EXPECT_TRUE(startTestMprisPlayer("testplayer1"));
+
+    // start now the indicator, so it picks the new volumes
+    ASSERT_NO_THROW(startIndicator());
+
+    // the root item, with a playlist submenu in the player's section if it has playlists
+    auto rootItem = [INITIAL_VOLUME](unsigned int playlists)
+    {
+        auto section = mh::MenuItemMatcher()
+            .section()
+            .item(mh::MenuItemMatcher()
+                .action("indicator.testplayer1.desktop")
+                .label("TestPlayer1")
+                .themed_icon("icon", {"testplayer"})
+                .string_attribute("x-canonical-type", "com.canonical.unity.media-player")
+            )
+            .item(mh::MenuItemMatcher()
+                .string_attribute("x-canonical-previous-action","indicator.previous.testplayer1.desktop")
+                .string_attribute("x-canonical-play-action","indicator.play.testplayer1.desktop")
+                .string_attribute("x-canonical-next-action","indicator.next.testplayer1.desktop")
+                .string_attribute("x-canonical-type","com.canonical.unity.playback-item")
+            );
+
+        if (playlists > 0)
+        {
+            auto playlistSection = mh::MenuItemMatcher().section();
+            for (unsigned int i = 0; i < playlists; i++)
+            {
+                playlistSection.item(mh::MenuItemMatcher()
+                    .label("Playlist " + to_string(i))
+                );
+            }
+
+            section.item(mh::MenuItemMatcher()
+                .label("Choose Playlist")
+                .submenu()
+                .item(playlistSection)
+            );
+        }
+
+        return mh::MenuItemMatcher()
+            .action("indicator.root")
+            .string_attribute("x-canonical-type", "com.canonical.indicator.root")
+            .string_attribute("x-canonical-secondary-action", "indicator.mute")
+            .mode(mh::MenuItemMatcher::Mode::all)
+            .submenu()
+            .item(mh::MenuItemMatcher()
+                .section()
+                .item(mh::MenuItemMatcher().checkbox()
+                    .label("Mute")
+                )
+                .item(volumeSlider(INITIAL_VOLUME, "Volume"))
+            )
+            .item(section)
+            .item(mh::MenuItemMatcher()
+                            .label("Sound Settings…")
+             );
+    };
+
+    // the player starts without playlists
+    EXPECT_MATCHRESULT(mh::MenuMatcher(desktopParameters()).item(rootItem(0)).match());
+
+    // changes of the playlist count show up in the menu
+    EXPECT_TRUE(setTestMprisPlayerPlaylistCount("testplayer1", 2));
+    EXPECT_MATCHRESULT(mh::MenuMatcher(desktopParameters()).item(rootItem(2)).match());
+
+    EXPECT_TRUE(setTestMprisPlayerPlaylistCount("testplayer1", 3));
+    EXPECT_MATCHRESULT(mh::MenuMatcher(desktopParameters()).item(rootItem(3)).match());
+
+    EXPECT_TRUE(setTestMprisPlayerPlaylistCount("testplayer1", 0));
+    EXPECT_MATCHRESULT(mh::MenuMatcher(desktopParameters()).item(rootItem(0)).match());
+}
+
+TEST_F(TestIndicator, DesktopMprisPlayerNameChurn)
+{
+    double INITIAL_VOLUME = 0.0;
+
+    ASSERT_NO_THROW(startAccountsService());
+    EXPECT_TRUE(clearGSettingsPlayers());
+    ASSERT_NO_THROW(startPulseDesktop());
+
+    // initialize volumes in pulseaudio
+    EXPECT_FALSE(setStreamRestoreVolume("alert", INITIAL_VOLUME));
+    EXPECT_TRUE(setSinkVolume(INITIAL_VOLUME));
+
+    auto rootItem = [INITIAL_VOLUME](bool running)
+    {
+        auto playback = mh::MenuItemMatcher();
+        if (running)
+        {
+            playback.string_attribute("x-canonical-previous-action","indicator.previous.testplayer1.desktop")
+                .string_attribute("x-canonical-play-action","indicator.play.testplayer1.desktop")
+                .string_attribute("x-canonical-next-action","indicator.next.testplayer1.desktop");
+        }
+        else
+        {
+            playback.string_attribute("x-canonical-play-action","indicator.play.testplayer1.desktop");
+        }
+        playback.string_attribute("x-canonical-type","com.canonical.unity.playback-item");
+
+        return mh::MenuItemMatcher()
+            .action("indicator.root")
+            .string_attribute("x-canonical-type", "com.canonical.indicator.root")
+            .string_attribute("x-canonical-secondary-action", "indicator.mute")
+            .mode(mh::MenuItemMatcher::Mode::all)
+            .submenu()
+            .item(mh::MenuItemMatcher()
+                .section()
+                .item(mh::MenuItemMatcher().checkbox()
+                    .label("Mute")
+                )
+                .item(volumeSlider(INITIAL_VOLUME, "Volume"))
+            )
+            .item(mh::MenuItemMatcher()
+                .section()
+                .item(mh::MenuItemMatcher()
+                    .action("indicator.testplayer1.desktop")
+                    .label("TestPlayer1")
+                    .themed_icon("icon", {"testplayer"})
+                    .string_attribute("x-canonical-type", "com.canonical.unity.media-player")
+                )
+                .item(playback)
+            )
+            .item(mh::MenuItemMatcher()
+                            .label("Sound Settings…")
+             );
+    };
+
+    // start the test player
+    EXPECT_TRUE(startTestMprisPlayer("testplayer1"));
+
+    // start now the indicator, so it picks the new volumes
+    ASSERT_NO_THROW(startIndicator());
+
+    EXPECT_MATCHRESULT(mh::MenuMatcher(desktopParameters()).item(rootItem(true)).match());
+
+    // make several hundred names of the same player appear and vanish per second
+    EXPECT_TRUE(runTestMprisPlayerChurn("testplayer1", 500, 5));
+
+    // vanishing names must not detach the instance that is still running
+    EXPECT_MATCHRESULT(mh::MenuMatcher(desktopParameters()).item(rootItem(true)).match());
+
+    // stop the test player
+    EXPECT_TRUE(stopTestMprisPlayer("testplayer1"));
+
+    EXPECT_MATCHRESULT(mh::MenuMatcher(desktopParameters()).item(rootItem(false)).match());
+}
+
+TEST_F(TestIndicator, DesktopMprisPlayerInstances)
+{
+    double INITIAL_VOLUME = 0.0;
+
+    ASSERT_NO_THROW(startAccountsService());
+    EXPECT_TRUE(clearGSettingsPlayers());
+    ASSERT_NO_THROW(startPulseDesktop());
+
+    // initialize volumes in pulseaudio
+    EXPECT_FALSE(setStreamRestoreVolume("alert", INITIAL_VOLUME));
+    EXPECT_TRUE(setSinkVolume(INITIAL_VOLUME));
+
+    // start the test player
+    EXPECT_TRUE(startTestMprisPlayer("testplayer1"));
+
+    // start now the indicator, so it picks the new volumes
+    ASSERT_NO_THROW(startIndicator());
+
+    EXPECT_MATCHRESULT(mh::MenuMatcher(desktopParameters())
+        .item(mh::MenuItemMatcher()
+            .action("indicator.root")
+            .string_attribute("x-canonical-type", "com.canonical.indicator.root")
+            .string_attribute("x-canonical-secondary-action", "indicator.mute")
+            .mode(mh::MenuItemMatcher::Mode::all)
+            .submenu()
+            .item(mh::MenuItemMatcher()
+                .section()
+                .item(mh::MenuItemMatcher().checkbox()
+                    .label("Mute")
+                )
+                .item(volumeSlider(INITIAL_VOLUME, "Volume"))
+            )
+            .item(mh::MenuItemMatcher()
+                .section()
+                .item(mh::MenuItemMatcher()
+                    .action("indicator.testplayer1.desktop")
+                    .label("TestPlayer1")
+                    .themed_icon("icon", {"testplayer"})
+                    .string_attribute("x-canonical-type", "com.canonical.unity.media-player")
+                )
+                .item(mh::MenuItemMatcher()
+                    .string_attribute("x-canonical-previous-action","indicator.previous.testplayer1.desktop")
+                    .string_attribute("x-canonical-play-action","indicator.play.testplayer1.desktop")
+                    .string_attribute("x-canonical-next-action","indicator.next.testplayer1.desktop")
+                    .string_attribute("x-canonical-type","com.canonical.unity.playback-item")
+                )
+            )
+            .item(mh::MenuItemMatcher()
+                            .label("Sound Settings…")
+             )
+        ).match());
+
+    // start a second instance of the same player
+    EXPECT_TRUE(startTestMprisPlayer("testplayer1", "instance2"));
+
+    // check that it gets its own section
+    EXPECT_MATCHRESULT(mh::MenuMatcher(desktopParameters())
+        .item(mh::MenuItemMatcher()
+            .action("indicator.root")
+            .string_attribute("x-canonical-type", "com.canonical.indicator.root")
+            .string_attribute("x-canonical-secondary-action", "indicator.mute")
+            .mode(mh::MenuItemMatcher::Mode::all)
+            .submenu()
+            .item(mh::MenuItemMatcher()
+                .section()
+                .item(mh::MenuItemMatcher().checkbox()
+                    .label("Mute")
+                )
+                .item(volumeSlider(INITIAL_VOLUME, "Volume"))
+            )
+            .item(mh::MenuItemMatcher()
+                .section()
+                .item(mh::MenuItemMatcher()
+                    .action("indicator.testplayer1.desktop")
+                    .label("TestPlayer1")
+                    .themed_icon("icon", {"testplayer"})
+                    .string_attribute("x-canonical-type", "com.canonical.unity.media-player")
+                )
+                .item(mh::MenuItemMatcher()
+                    .string_attribute("x-canonical-previous-action","indicator.previous.testplayer1.desktop")
+                    .string_attribute("x-canonical-play-action","indicator.play.testplayer1.desktop")
+                    .string_attribute("x-canonical-next-action","indicator.next.testplayer1.desktop")
+                    .string_attribute("x-canonical-type","com.canonical.unity.playback-item")
+                )
+            )
+            .item(mh::MenuItemMatcher()
+                .section()
+                .item(mh::MenuItemMatcher()
+                    .action("indicator.testplayer1.desktop.2")
+                    .label("TestPlayer1 (2)")
+                    .themed_icon("icon", {"testplayer"})
+                    .string_attribute("x-canonical-type", "com.canonical.unity.media-player")
+                )
+                .item(mh::MenuItemMatcher()
+                    .string_attribute("x-canonical-previous-action","indicator.previous.testplayer1.desktop.2")
+                    .string_attribute("x-canonical-play-action","indicator.play.testplayer1.desktop.2")
+                    .string_attribute("x-canonical-next-action","indicator.next.testplayer1.desktop.2")
+                    .string_attribute("x-canonical-type","com.canonical.unity.playback-item")
+                )
+            )
+            .item(mh::MenuItemMatcher()
+                            .label("Sound Settings…")
+             )
+        ).match());
+
+    // stop the second instance
+    EXPECT_TRUE(stopTestMprisPlayer("testplayer1.instance2"));
+
+    // check that its section is removed, and the first instance is untouched
+    EXPECT_MATCHRESULT(mh::MenuMatcher(desktopParameters())
+        .item(mh::MenuItemMatcher()
+            .action("indicator.root")
+            .string_attribute("x-canonical-type", "com.canonical.indicator.root")
+            .string_attribute("x-canonical-secondary-action", "indicator.mute")
+            .mode(mh::MenuItemMatcher::Mode::all)
+            .submenu()
+            .item(mh::MenuItemMatcher()
+                .section()
+                .item(mh::MenuItemMatcher().checkbox()
+                    .label("Mute")
+                )
+                .item(volumeSlider(INITIAL_VOLUME, "Volume"))
+            )
+            .item(mh::MenuItemMatcher()
+                .section()
+                .item(mh::MenuItemMatcher()
+                    .action("indicator.testplayer1.desktop")
+                    .label("TestPlayer1")
+                    .themed_icon("icon", {"testplayer"})
+                    .string_attribute("x-canonical-type", "com.canonical.unity.media-player")
+                )
+                .item(mh::MenuItemMatcher()
+                    .string_attribute("x-canonical-previous-action","indicator.previous.testplayer1.desktop")
+                    .string_attribute("x-canonical-play-action","indicator.play.testplayer1.desktop")
+                    .string_attribute("x-canonical-next-action","indicator.next.testplayer1.desktop")
+                    .string_attribute("x-canonical-type","com.canonical.unity.playback-item")
+                )
+            )
+            .item(mh::MenuItemMatcher()
+                            .label("Sound Settings…")
+             )
+        ).match());
+
+    // start the second instance again
+    EXPECT_TRUE(startTestMprisPlayer("testplayer1", "instance2"));
+
+    // check that it gets its own section again
+    EXPECT_MATCHRESULT(mh::MenuMatcher(desktopParameters())
+        .item(mh::MenuItemMatcher()
+            .action("indicator.root")
+            .string_attribute("x-canonical-type", "com.canonical.indicator.root")
+            .string_attribute("x-canonical-secondary-action", "indicator.mute")
+            .mode(mh::MenuItemMatcher::Mode::all)
+            .submenu()
+            .item(mh::MenuItemMatcher()
+                .section()
+                .item(mh::MenuItemMatcher().checkbox()
+                    .label("Mute")
+                )
+                .item(volumeSlider(INITIAL_VOLUME, "Volume"))
+            )
+            .item(mh::MenuItemMatcher()
+                .section()
+                .item(mh::MenuItemMatcher()
+                    .action("indicator.testplayer1.desktop")
+                    .label("TestPlayer1")
+                    .themed_icon("icon", {"testplayer"})
+                    .string_attribute("x-canonical-type", "com.canonical.unity.media-player")
+                )
+                .item(mh::MenuItemMatcher()
+                    .string_attribute("x-canonical-previous-action","indicator.previous.testplayer1.desktop")
+                    .string_attribute("x-canonical-play-action","indicator.play.testplayer1.desktop")
+                    .string_attribute("x-canonical-next-action","indicator.next.testplayer1.desktop")
+                    .string_attribute("x-canonical-type","com.canonical.unity.playback-item")
+                )
+            )
+            .item(mh::MenuItemMatcher()
+                .section()
+                .item(mh::MenuItemMatcher()
+                    .action("indicator.testplayer1.desktop.2")
+                    .label("TestPlayer1 (2)")
+                    .themed_icon("icon", {"testplayer"})
+                    .string_attribute("x-canonical-type", "com.canonical.unity.media-player")
+                )
+                .item(mh::MenuItemMatcher()
+                    .string_attribute("x-canonical-previous-action","indicator.previous.testplayer1.desktop.2")
+                    .string_attribute("x-canonical-play-action","indicator.play.testplayer1.desktop.2")
+                    .string_attribute("x-canonical-next-action","indicator.next.testplayer1.desktop.2")
+                    .string_attribute("x-canonical-type","com.canonical.unity.playback-item")
+                )
+            )
+            .item(mh::MenuItemMatcher()
+                            .label("Sound Settings…")
+             )
+        ).match());
+
+    // and stop the first one instead
+    EXPECT_TRUE(stopTestMprisPlayer("testplayer1"));
+
+    // check that the second instance takes over the player's own section
+    EXPECT_MATCHRESULT(mh::MenuMatcher(desktopParameters())
+        .item(mh::MenuItemMatcher()
+            .action("indicator.root")
+            .string_attribute("x-canonical-type", "com.canonical.indicator.root")
+            .string_attribute("x-canonical-secondary-action", "indicator.mute")
+            .mode(mh::MenuItemMatcher::Mode::all)
+            .submenu()
+            .item(mh::MenuItemMatcher()
+                .section()
+                .item(mh::MenuItemMatcher().checkbox()
+                    .label("Mute")
+                )
+                .item(volumeSlider(INITIAL_VOLUME, "Volume"))
+            )
+            .item(mh::MenuItemMatcher()
+                .section()
+                .item(mh::MenuItemMatcher()
+                    .action("indicator.testplayer1.desktop")
+                    .label("TestPlayer1")
+                    .themed_icon("icon", {"testplayer"})
+                    .string_attribute("x-canonical-type", "com.canonical.unity.media-player")
+                )
+                .item(mh::MenuItemMatcher()
+                    .string_attribute("x-canonical-previous-action","indicator.previous.testplayer1.desktop")
+                    .string_attribute("x-canonical-play-action","indicator.play.testplayer1.desktop")
+                    .string_attribute("x-canonical-next-action","indicator.next.testplayer1.desktop")
+                    .string_attribute("x-canonical-type","com.canonical.unity.playback-item")
+                )
+            )
+            .item(mh::MenuItemMatcher()
+                            .label("Sound Settings…")
+             )
+        ).match());
+}
+
 TEST_F(TestIndicator, DesktopChangeRoleVolume)
 {
     double INITIAL_VOLUME = 0.0;
@@ -33,6 +33,9 @@ public class MediaPlayerMock: MediaPlayer {
 	public override bool can_do_play { get { return mock_can_do_play; } }
 
 	public override MediaPlayer.Track? current_track { get { return mock_current_track; } set { this.mock_current_track = value; } }
+	public override int64 position { get { return mock_position; } }
+	public override int64 position_time { get { return mock_position_time; } }
+	public override double rate { get { return mock_rate; } }
 
 	/* Mock values */
 	public string mock_id { get; set; }
@@ -48,6 +51,13 @@ public class MediaPlayerMock: MediaPlayer {
 	public bool mock_can_do_play { get; set; }
 
 	public MediaPlayer.Track? mock_current_track { get; set; } 
+	public int64 mock_position { get; set; default = -1; }
+	public int64 mock_position_time { get; set; }
+	public double mock_rate { get; set; default = 1.0; }
+
+	/* Parallel arrays, set both and emit playlists-changed */
+	public string[] mock_playlist_ids { get; set; default = {}; }
+	public string[] mock_playlist_names { get; set; default = {}; }
 
 	/* Virtual functions */
 	public override void activate () {
@@ -65,15 +75,15 @@ public class MediaPlayerMock: MediaPlayer {
 
 	public override uint get_n_playlists() {
 		debug("Mock get_n_playlists");
-		return 0;
+		return mock_playlist_ids.length;
 	}
 	public override string get_playlist_id (int index) {
 		debug("Mock get_playlist_id");
-		return "";
+		return mock_playlist_ids[index];
 	}
 	public override string get_playlist_name (int index) {
 		debug("Mock get_playlist_name");
-		return "";
+		return mock_playlist_names[index];
 	}
 	public override void activate_playlist_by_name (string playlist) {
 		debug("Mock activate_playlist_by_name");
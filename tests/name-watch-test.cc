@@ -19,6 +19,7 @@
 
 #include <gio/gio.h>
 #include <gtest/gtest.h>
+#include <vector>
 
 extern "C" {
 #include "bus-watch-namespace.h"
@@ -173,3 +174,240 @@ TEST_F(NameWatchTest, StartupNames)
 	bus_unwatch_namespace(ns_watch);
 }
 
+
+TEST_F(NameWatchTest, SharedWatch)
+{
+	callback_count_t first_count = {0};
+	callback_count_t second_count = {0};
+
+	guint first_watch = bus_watch_namespace(G_BUS_TYPE_SESSION,
+	                                        "com.foo",
+	                                        appeared_simple_cb,
+	                                        vanished_simple_cb,
+	                                        &first_count,
+	                                        NULL);
+
+	guint name1 = g_bus_own_name(G_BUS_TYPE_SESSION,
+	                             "com.foo.bar",
+	                             G_BUS_NAME_OWNER_FLAGS_NONE,
+	                             NULL, NULL, NULL, NULL, NULL);
+
+	loop(100);
+
+	ASSERT_EQ(first_count.appeared, 1);
+
+	/* a second watcher of the same namespace is told about names that are already known */
+	guint second_watch = bus_watch_namespace(G_BUS_TYPE_SESSION,
+	                                         "com.foo",
+	                                         appeared_simple_cb,
+	                                         vanished_simple_cb,
+	                                         &second_count,
+	                                         NULL);
+	ASSERT_NE(first_watch, second_watch);
+
+	loop(100);
+
+	ASSERT_EQ(first_count.appeared, 1);
+	ASSERT_EQ(second_count.appeared, 1);
+
+	guint name2 = g_bus_own_name(G_BUS_TYPE_SESSION,
+	                             "com.foo.bar_too",
+	                             G_BUS_NAME_OWNER_FLAGS_NONE,
+	                             NULL, NULL, NULL, NULL, NULL);
+
+	loop(100);
+
+	ASSERT_EQ(first_count.appeared, 2);
+	ASSERT_EQ(second_count.appeared, 2);
+
+	/* removing one watcher doesn't affect the other one */
+	bus_unwatch_namespace(first_watch);
+
+	g_bus_unown_name(name1);
+	g_bus_unown_name(name2);
+
+	loop(100);
+
+	ASSERT_EQ(first_count.vanished, 0);
+	ASSERT_EQ(second_count.vanished, 2);
+
+	bus_unwatch_namespace(second_watch);
+}
+
+typedef struct {
+	guint appeared;
+	gchar * owner;
+	GMainLoop * loop;
+} owner_lookup_t;
+
+static void
+appeared_owner_cb (GDBusConnection * bus, const gchar * name, const gchar * owner, gpointer user_data)
+{
+	owner_lookup_t * lookup = static_cast<owner_lookup_t *>(user_data);
+	lookup->appeared++;
+	g_free(lookup->owner);
+	lookup->owner = g_strdup(owner);
+}
+
+static void
+got_owner_cb (GObject * object, GAsyncResult * result, gpointer user_data)
+{
+	owner_lookup_t * lookup = static_cast<owner_lookup_t *>(user_data);
+	g_free(lookup->owner);
+	lookup->owner = bus_watch_namespace_get_name_owner_finish(result, NULL);
+	g_main_loop_quit(lookup->loop);
+}
+
+TEST_F(NameWatchTest, LazyOwner)
+{
+	owner_lookup_t lookup = {0};
+	lookup.loop = g_main_loop_new(NULL, FALSE);
+
+	GDBusConnection * session = g_bus_get_sync(G_BUS_TYPE_SESSION, NULL, NULL);
+	ASSERT_NE(nullptr, session);
+
+	guint name = g_bus_own_name(G_BUS_TYPE_SESSION,
+	                            "com.foo.bar",
+	                            G_BUS_NAME_OWNER_FLAGS_NONE,
+	                            NULL, NULL, NULL, NULL, NULL);
+	loop(100);
+
+	guint ns_watch = bus_watch_namespace_with_flags(G_BUS_TYPE_SESSION,
+	                                                "com.foo",
+	                                                BUS_WATCH_NAMESPACE_FLAGS_LAZY_OWNER,
+	                                                appeared_owner_cb,
+	                                                NULL,
+	                                                &lookup,
+	                                                NULL);
+	loop(100);
+
+	/* Names that were there already are reported without their owner */
+	ASSERT_EQ(1u, lookup.appeared);
+	EXPECT_EQ(nullptr, lookup.owner);
+
+	/* But it can be looked up */
+	bus_watch_namespace_get_name_owner(ns_watch, "com.foo.bar", NULL, got_owner_cb, &lookup);
+	g_main_loop_run(lookup.loop);
+	EXPECT_STREQ(g_dbus_connection_get_unique_name(session), lookup.owner);
+
+	/* Names that weren't reported fail */
+	bus_watch_namespace_get_name_owner(ns_watch, "com.foo.baz", NULL, got_owner_cb, &lookup);
+	g_main_loop_run(lookup.loop);
+	EXPECT_EQ(nullptr, lookup.owner);
+
+	bus_unwatch_namespace(ns_watch);
+	g_bus_unown_name(name);
+	loop(100);
+
+	g_free(lookup.owner);
+	g_main_loop_unref(lookup.loop);
+	g_object_unref(session);
+}
+
+TEST_F(NameWatchTest, MixedFlags)
+{
+	owner_lookup_t lazy = {0};
+	owner_lookup_t eager = {0};
+
+	GDBusConnection * session = g_bus_get_sync(G_BUS_TYPE_SESSION, NULL, NULL);
+	ASSERT_NE(nullptr, session);
+
+	guint name = g_bus_own_name(G_BUS_TYPE_SESSION,
+	                            "com.foo.bar",
+	                            G_BUS_NAME_OWNER_FLAGS_NONE,
+	                            NULL, NULL, NULL, NULL, NULL);
+	loop(100);
+
+	/* Both watchers share one subscription, each still gets what it asked for */
+	guint lazy_watch = bus_watch_namespace_with_flags(G_BUS_TYPE_SESSION,
+	                                                  "com.foo",
+	                                                  BUS_WATCH_NAMESPACE_FLAGS_LAZY_OWNER,
+	                                                  appeared_owner_cb,
+	                                                  NULL,
+	                                                  &lazy,
+	                                                  NULL);
+	loop(100);
+	guint eager_watch = bus_watch_namespace_with_flags(G_BUS_TYPE_SESSION,
+	                                                   "com.foo",
+	                                                   BUS_WATCH_NAMESPACE_FLAGS_NONE,
+	                                                   appeared_owner_cb,
+	                                                   NULL,
+	                                                   &eager,
+	                                                   NULL);
+	loop(100);
+
+	ASSERT_EQ(1u, lazy.appeared);
+	EXPECT_EQ(nullptr, lazy.owner);
+	ASSERT_EQ(1u, eager.appeared);
+	EXPECT_STREQ(g_dbus_connection_get_unique_name(session), eager.owner);
+
+	bus_unwatch_namespace(lazy_watch);
+	bus_unwatch_namespace(eager_watch);
+	g_bus_unown_name(name);
+	loop(100);
+
+	g_free(lazy.owner);
+	g_free(eager.owner);
+	g_object_unref(session);
+}
+
+static void
+name_acquired_cb (GDBusConnection * bus, const gchar * name, gpointer user_data)
+{
+	guint * acquired = static_cast<guint *>(user_data);
+	(*acquired)++;
+}
+
+/* Measures how long it takes until 1000 names that are on the bus before the
+   watcher is created have all been reported, with and without owner lookups. */
+TEST_F(NameWatchTest, StartupNamesBenchmark)
+{
+	const guint n_names = 1000;
+	guint acquired = 0;
+	std::vector<guint> names;
+
+	for (guint i = 0; i < n_names; i++) {
+		gchar * name = g_strdup_printf("com.foo.bench%u", i);
+		names.push_back(g_bus_own_name(G_BUS_TYPE_SESSION,
+		                               name,
+		                               G_BUS_NAME_OWNER_FLAGS_NONE,
+		                               NULL, name_acquired_cb, NULL, &acquired, NULL));
+		g_free(name);
+	}
+
+	gint64 deadline = g_get_monotonic_time() + 30 * G_TIME_SPAN_SECOND;
+	while (acquired < n_names && g_get_monotonic_time() < deadline)
+		g_main_context_iteration(NULL, TRUE);
+	ASSERT_EQ(n_names, acquired);
+
+	BusWatchNamespaceFlags modes[] = { BUS_WATCH_NAMESPACE_FLAGS_NONE, BUS_WATCH_NAMESPACE_FLAGS_LAZY_OWNER };
+	for (auto flags : modes) {
+		callback_count_t callback_count = {0};
+
+		gint64 start = g_get_monotonic_time();
+		guint ns_watch = bus_watch_namespace_with_flags(G_BUS_TYPE_SESSION,
+		                                                "com.foo",
+		                                                flags,
+		                                                appeared_simple_cb,
+		                                                vanished_simple_cb,
+		                                                &callback_count,
+		                                                NULL);
+
+		deadline = start + 30 * G_TIME_SPAN_SECOND;
+		while (callback_count.appeared < n_names && g_get_monotonic_time() < deadline)
+			g_main_context_iteration(NULL, TRUE);
+
+		g_print("%u names reported in %" G_GINT64_FORMAT " ms (%s)\n", callback_count.appeared,
+		        (g_get_monotonic_time() - start) / 1000,
+		        flags & BUS_WATCH_NAMESPACE_FLAGS_LAZY_OWNER ? "lazy owners" : "GetNameOwner");
+
+		EXPECT_EQ(n_names, callback_count.appeared);
+
+		bus_unwatch_namespace(ns_watch);
+	}
+
+	for (auto name : names)
+		g_bus_unown_name(name);
+
+	loop(100);
+}
@@ -20,6 +20,7 @@
 #include <algorithm>
 #include <map>
 #include <memory>
+#include <string>
 #include <type_traits>
 
 #include <libdbustest/dbus-test.h>
@@ -30,14 +31,18 @@ class NotificationsMock
 		DbusTestDbusMockObject * baseobj = nullptr;
 
 	public:
-		NotificationsMock (std::vector<std::string> capabilities = {"actions", "body", "body-markup", "icon-static", "image/svg+xml", "x-canonical-private-synchronous", "x-canonical-append", "x-canonical-private-icon-only", "x-canonical-truncation", "private-synchronous", "append", "private-icon-only", "truncation"}) {
+		NotificationsMock (std::vector<std::string> capabilities = {"actions", "body", "body-markup", "icon-static", "image/svg+xml", "x-canonical-private-synchronous", "x-canonical-append", "x-canonical-private-icon-only", "x-canonical-truncation", "private-synchronous", "append", "private-icon-only", "truncation"}, unsigned int capabilities_delay_ms = 0) {
 			mock = dbus_test_dbus_mock_new("org.freedesktop.Notifications");
 			dbus_test_task_set_bus(DBUS_TEST_TASK(mock), DBUS_TEST_SERVICE_BUS_SESSION);
 			dbus_test_task_set_name(DBUS_TEST_TASK(mock), "Notify");
 
 			baseobj =dbus_test_dbus_mock_get_object(mock, "/org/freedesktop/Notifications", "org.freedesktop.Notifications", nullptr);
 
-			std::string capspython("ret = ");
+			/* A slow server, to check that nobody waits for it */
+			std::string capspython;
+			if (capabilities_delay_ms > 0)
+				capspython += "import time\ntime.sleep(" + std::to_string(capabilities_delay_ms / 1000.0) + ")\n";
+			capspython += "ret = ";
 			capspython += vector2py(capabilities);
 			dbus_test_dbus_mock_object_add_method(mock, baseobj,
 				"GetCapabilities", nullptr, G_VARIANT_TYPE("as"),
@@ -140,6 +140,13 @@ class NotificationsTest : public ::testing::Test
             loop_until(test, max_seconds);
         }
 
+        /* The server answers GetCapabilities whenever it gets to it, so wait for
+           the service to have them (or to have forgotten them) */
+        void loop_until_server_caps(bool known=true, unsigned int max_ms=5000) {
+            auto test = [known]{ return bool(indicator_sound_notification_server_caps_known()) == known; };
+            loop_until(test, max_ms);
+        }
+
         static int unref_idle (gpointer user_data) {
             g_variant_unref(static_cast<GVariant *>(user_data));
             return G_SOURCE_REMOVE;
@@ -193,6 +200,9 @@ class NotificationsTest : public ::testing::Test
                     g_clear_object(&service);
                 });
 
+            /* Let the notifications get the server's capabilities */
+            loop_until_server_caps();
+
             return soundService;
         }
 
@@ -377,12 +387,12 @@ TEST_F(NotificationsTest, ServerRestart) {
     notifications->clearNotifications();
     dbus_test_service_remove_task(service, (DbusTestTask*)*notifications);
     notifications.reset();
-
-    loop(50);
+    loop_until_server_caps(false);
 
     notifications = std::make_shared<NotificationsMock>(std::vector<std::string>({"body", "body-markup", "icon-static"}));
     dbus_test_service_add_task(service, (DbusTestTask*)*notifications);
     dbus_test_task_run((DbusTestTask*)*notifications);
+    loop_until_server_caps();
 
     /* Change the volume */
     notifications->clearNotifications();
@@ -394,12 +404,12 @@ TEST_F(NotificationsTest, ServerRestart) {
     /* Put a good server back */
     dbus_test_service_remove_task(service, (DbusTestTask*)*notifications);
     notifications.reset();
-
-    loop(50);
+    loop_until_server_caps(false);
 
     notifications = std::make_shared<NotificationsMock>();
     dbus_test_service_add_task(service, (DbusTestTask*)*notifications);
     dbus_test_task_run((DbusTestTask*)*notifications);
+    loop_until_server_caps();
 
     /* Change the volume again */
     notifications->clearNotifications();
@@ -409,6 +419,44 @@ TEST_F(NotificationsTest, ServerRestart) {
     ASSERT_EQ(1, notev.size());
 }
 
+TEST_F(NotificationsTest, SlowServer) {
+    auto options = optionsMock();
+    auto volumeControl = volumeControlMock(options);
+    auto volumeWarning = volumeWarningMock(options);
+    auto accountsService = std::make_shared<AccountsServiceAccess>();
+    auto soundService = standardService(volumeControl, playerListMock(), options, volumeWarning, accountsService);
+
+    /* Replace the server with one that takes a second to report its capabilities */
+    dbus_test_service_remove_task(service, (DbusTestTask*)*notifications);
+    notifications.reset();
+    loop_until_server_caps(false);
+
+    notifications = std::make_shared<NotificationsMock>(std::vector<std::string>({"actions", "body", "x-canonical-private-synchronous"}), 1000);
+    dbus_test_service_add_task(service, (DbusTestTask*)*notifications);
+    dbus_test_task_run((DbusTestTask*)*notifications);
+
+    /* Showing must not wait for the capabilities, the bubble is skipped instead */
+    notifications->clearNotifications();
+    auto start = g_get_monotonic_time();
+    setMockVolume(volumeControl, 0.60);
+    EXPECT_GT(100 * G_TIME_SPAN_MILLISECOND, g_get_monotonic_time() - start);
+    loop(50);
+    auto notev = notifications->getNotifications();
+    EXPECT_EQ(0, notev.size());
+
+    /* Once they have arrived, bubbles are shown again */
+    loop_until_server_caps();
+    ASSERT_TRUE(indicator_sound_notification_server_caps_known());
+    notifications->clearNotifications();
+    start = g_get_monotonic_time();
+    setMockVolume(volumeControl, 0.70);
+    EXPECT_GT(100 * G_TIME_SPAN_MILLISECOND, g_get_monotonic_time() - start);
+    loop_until([this]{ return !notifications->getNotifications().empty(); }, 5000);
+    notev = notifications->getNotifications();
+    ASSERT_EQ(1, notev.size());
+    EXPECT_GVARIANT_EQ("@i 70", notev[0].hints["value"]);
+}
+
 TEST_F(NotificationsTest, HighVolume) {
     auto options = optionsMock();
     auto volumeControl = volumeControlMock(options);
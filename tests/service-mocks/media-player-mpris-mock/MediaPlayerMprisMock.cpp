@@ -16,19 +16,41 @@
  * Author: Xavi Garcia <xavi.garcia.mena@canonical.com>
  */
 #include <QDebug>
+#include <QDBusMetaType>
 
 #include "MediaPlayerMprisMock.h"
 
 using namespace ubuntu::indicators::testing;
 
-MediaPlayerMprisMock::MediaPlayerMprisMock(QString const &playerName, QObject* parent)
+QDBusArgument &operator<<(QDBusArgument &argument, MprisPlaylist const &playlist)
+{
+    argument.beginStructure();
+    argument << playlist.id << playlist.name << playlist.icon;
+    argument.endStructure();
+    return argument;
+}
+
+QDBusArgument const &operator>>(QDBusArgument const &argument, MprisPlaylist &playlist)
+{
+    argument.beginStructure();
+    argument >> playlist.id >> playlist.name >> playlist.icon;
+    argument.endStructure();
+    return argument;
+}
+
+MediaPlayerMprisMock::MediaPlayerMprisMock(QString const &playerName, QObject* parent, QDBusConnection const &connection)
     : QObject(parent)
     , can_play_(true)
     , can_pause_(true)
     , can_gonext_(true)
     , can_goprevious_(true)
+    , playback_status_("Stopped")
+    , playlist_count_(0)
     , player_name_(playerName)
+    , connection_(connection)
 {
+    qDBusRegisterMetaType<MprisPlaylist>();
+    qDBusRegisterMetaType<MprisPlaylistList>();
 }
 
 MediaPlayerMprisMock::~MediaPlayerMprisMock() = default;
@@ -41,7 +63,7 @@ bool MediaPlayerMprisMock::canPlay() const
 void MediaPlayerMprisMock::setCanPlay(bool canPlay)
 {
     can_play_ = canPlay;
-    notifier_.notifyPropertyChanged(QDBusConnection::sessionBus(),
+    notifier_.notifyPropertyChanged(connection_,
                                     "org.mpris.MediaPlayer2.Player",
                                     "/org/mpris/MediaPlayer2",
                                     "CanPlay",
@@ -56,7 +78,7 @@ bool MediaPlayerMprisMock::canPause() const
 void MediaPlayerMprisMock::setCanPause(bool canPause)
 {
     can_pause_ = canPause;
-    notifier_.notifyPropertyChanged(QDBusConnection::sessionBus(),
+    notifier_.notifyPropertyChanged(connection_,
                                     "org.mpris.MediaPlayer2.Player",
                                     "/org/mpris/MediaPlayer2",
                                     "CanPause",
@@ -71,7 +93,7 @@ bool MediaPlayerMprisMock::canGoNext() const
 void MediaPlayerMprisMock::setCanGoNext(bool canGoNext)
 {
     can_gonext_ = canGoNext;
-    notifier_.notifyPropertyChanged(QDBusConnection::sessionBus(),
+    notifier_.notifyPropertyChanged(connection_,
                                     "org.mpris.MediaPlayer2.Player",
                                     "/org/mpris/MediaPlayer2",
                                     "CanGoNext",
@@ -86,7 +108,7 @@ bool MediaPlayerMprisMock::canGoPrevious() const
 void MediaPlayerMprisMock::setCanGoPrevious(bool canGoPrevious)
 {
     can_goprevious_ = canGoPrevious;
-    notifier_.notifyPropertyChanged(QDBusConnection::sessionBus(),
+    notifier_.notifyPropertyChanged(connection_,
                                     "org.mpris.MediaPlayer2.Player",
                                     "/org/mpris/MediaPlayer2",
                                     "CanGoPrevious",
@@ -101,3 +123,71 @@ QString MediaPlayerMprisMock::desktopEntry() const
 void MediaPlayerMprisMock::setDesktopEntry(QString const &)
 {
 }
+
+QString MediaPlayerMprisMock::playbackStatus() const
+{
+    return playback_status_;
+}
+
+void MediaPlayerMprisMock::setPlaybackStatus(QString const &playbackStatus)
+{
+    playback_status_ = playbackStatus;
+    notifier_.notifyPropertyChanged(connection_,
+                                    "org.mpris.MediaPlayer2.Player",
+                                    "/org/mpris/MediaPlayer2",
+                                    "PlaybackStatus",
+                                    property("PlaybackStatus"));
+}
+
+QVariantMap MediaPlayerMprisMock::metadata() const
+{
+    return metadata_;
+}
+
+void MediaPlayerMprisMock::setMetadata(QVariantMap const &metadata)
+{
+    metadata_ = metadata;
+    notifier_.notifyPropertyChanged(connection_,
+                                    "org.mpris.MediaPlayer2.Player",
+                                    "/org/mpris/MediaPlayer2",
+                                    "Metadata",
+                                    property("Metadata"));
+}
+
+uint MediaPlayerMprisMock::playlistCount() const
+{
+    return playlist_count_;
+}
+
+void MediaPlayerMprisMock::setPlaylistCount(uint playlistCount)
+{
+    playlist_count_ = playlistCount;
+    notifier_.notifyPropertyChanged(connection_,
+                                    "org.mpris.MediaPlayer2.Playlists",
+                                    "/org/mpris/MediaPlayer2",
+                                    "PlaylistCount",
+                                    property("PlaylistCount"));
+}
+
+QStringList MediaPlayerMprisMock::orderings() const
+{
+    return QStringList() << "Alphabetical";
+}
+
+MprisPlaylistList MediaPlayerMprisMock::GetPlaylists(uint index, uint maxCount, QString const &, bool)
+{
+    MprisPlaylistList playlists;
+    for (uint i = index; i < playlist_count_ && i < index + maxCount; i++)
+    {
+        MprisPlaylist playlist;
+        playlist.id = QDBusObjectPath(QString("/org/mpris/MediaPlayer2/Playlist/%1").arg(i));
+        playlist.name = QString("Playlist %1").arg(i);
+        playlists << playlist;
+    }
+    Q_EMIT playlistsFetched(playlist_count_);
+    return playlists;
+}
+
+void MediaPlayerMprisMock::ActivatePlaylist(QDBusObjectPath const &)
+{
+}
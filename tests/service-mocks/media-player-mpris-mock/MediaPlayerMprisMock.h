@@ -17,12 +17,31 @@
  */
 #pragma once
 
+#include <QDBusArgument>
+#include <QDBusConnection>
 #include <QDBusContext>
 #include <QDBusObjectPath>
 #include <QObject>
+#include <QStringList>
+#include <QVariantMap>
 
 #include "DBusPropertiesNotifier.h"
 
+struct MprisPlaylist
+{
+    QDBusObjectPath id;
+    QString name;
+    QString icon;
+};
+
+typedef QList<MprisPlaylist> MprisPlaylistList;
+
+Q_DECLARE_METATYPE(MprisPlaylist)
+Q_DECLARE_METATYPE(MprisPlaylistList)
+
+QDBusArgument &operator<<(QDBusArgument &argument, MprisPlaylist const &playlist);
+QDBusArgument const &operator>>(QDBusArgument const &argument, MprisPlaylist &playlist);
+
 namespace ubuntu
 {
 
@@ -40,6 +59,10 @@ class MediaPlayerMprisMock : public QObject, protected QDBusContext
     Q_PROPERTY(bool CanGoNext READ canGoNext WRITE setCanGoNext)
     Q_PROPERTY(bool CanGoPrevious READ canGoPrevious WRITE setCanGoPrevious)
     Q_PROPERTY(QString DesktopEntry READ desktopEntry WRITE setDesktopEntry)
+    Q_PROPERTY(QString PlaybackStatus READ playbackStatus WRITE setPlaybackStatus)
+    Q_PROPERTY(QVariantMap Metadata READ metadata WRITE setMetadata)
+    Q_PROPERTY(uint PlaylistCount READ playlistCount WRITE setPlaylistCount)
+    Q_PROPERTY(QStringList Orderings READ orderings)
 
 public Q_SLOTS:
     bool canPlay() const;
@@ -57,8 +80,27 @@ public Q_SLOTS:
     QString desktopEntry() const;
     void setDesktopEntry(QString const &destopEntry);
 
+    QString playbackStatus() const;
+    void setPlaybackStatus(QString const &playbackStatus);
+
+    QVariantMap metadata() const;
+    void setMetadata(QVariantMap const &metadata);
+
+    uint playlistCount() const;
+    void setPlaylistCount(uint playlistCount);
+
+    QStringList orderings() const;
+
+    MprisPlaylistList GetPlaylists(uint index, uint maxCount, QString const &order, bool reverseOrder);
+    void ActivatePlaylist(QDBusObjectPath const &playlistId);
+
+Q_SIGNALS:
+    // emitted when a client fetched the playlists, which it does when PlaylistCount changes
+    void playlistsFetched(uint playlistCount);
+
 public:
-    MediaPlayerMprisMock(QString const &playerName, QObject* parent = 0);
+    MediaPlayerMprisMock(QString const &playerName, QObject* parent = 0,
+                         QDBusConnection const &connection = QDBusConnection::sessionBus());
     virtual ~MediaPlayerMprisMock();
 
 private:
@@ -66,8 +108,12 @@ private:
     bool can_pause_;
     bool can_gonext_;
     bool can_goprevious_;
+    QString playback_status_;
+    QVariantMap metadata_;
+    uint playlist_count_;
     DBusPropertiesNotifier notifier_;
     QString player_name_;
+    QDBusConnection connection_;
 };
 
 } // namespace testing
@@ -0,0 +1,485 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <QDBusArgument>
+#include <QDBusConnectionInterface>
+#include <QDBusMetaType>
+#include <QDBusReply>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+
+#include <algorithm>
+
+#include <unistd.h>
+
+#include "PlayerFarm.h"
+#include "MediaPlayerMprisMock.h"
+#include "MediaPlayerMprisMockAdaptor.h"
+#include "MediaPlayer2MockAdaptor.h"
+#include "MediaPlayerPlaylistsMockAdaptor.h"
+
+using namespace ubuntu::indicators::testing;
+
+namespace
+{
+constexpr int TICK_MS = 10;
+constexpr const char INDICATOR_SERVICE[] = "com.canonical.indicator.sound";
+constexpr const char INDICATOR_PATH[] = "/com/canonical/indicator/sound";
+
+QString playerName(int index)
+{
+    return QString("farmplayer%1").arg(index);
+}
+
+QString trackTitle(int index, quint64 serial)
+{
+    return QString("farm %1 #%2").arg(index).arg(serial);
+}
+
+/* Inverse of trackTitle() */
+bool parseTrackTitle(QString const &title, int &index, quint64 &serial)
+{
+    if (!title.startsWith("farm "))
+        return false;
+
+    QStringList parts = title.mid(5).split(" #");
+    if (parts.size() != 2)
+        return false;
+
+    bool indexOk, serialOk;
+    index = parts[0].toInt(&indexOk);
+    serial = parts[1].toULongLong(&serialOk);
+    return indexOk && serialOk;
+}
+
+double percentile(QVector<double> sorted, double p)
+{
+    if (sorted.isEmpty())
+        return 0;
+    return sorted[std::min<int>(sorted.size() - 1, int(p * sorted.size()))];
+}
+}
+
+struct PlayerFarm::Player
+{
+    Player(int index)
+        : index(index)
+        , name(playerName(index))
+        , service(QString("org.mpris.MediaPlayer2.") + name)
+        , connection(QDBusConnection::connectToBus(QDBusConnection::SessionBus, "farm-" + name))
+    {
+    }
+
+    ~Player()
+    {
+        QDBusConnection::disconnectFromBus("farm-" + name);
+    }
+
+    int index;
+    QString name;
+    QString service;
+    QDBusConnection connection;
+    MediaPlayerMprisMock *mock = nullptr;
+    bool registered = false;
+    quint64 serial = 0;
+    bool playing = false;
+    uint playlists = 0;
+
+    // changes not yet seen in the indicator, by serial
+    PendingChanges pendingTracks;
+    PendingChanges pendingStatus;
+    PendingChanges pendingPlaylists;
+
+    void clearPending()
+    {
+        pendingTracks.clear();
+        pendingStatus.clear();
+        pendingPlaylists.clear();
+    }
+};
+
+PlayerFarm::PlayerFarm(Options const &options, QObject *parent)
+    : QObject(parent)
+    , options_(options)
+{
+    connect(&tickTimer_, &QTimer::timeout, this, &PlayerFarm::tick);
+    connect(&reportTimer_, &QTimer::timeout, this, &PlayerFarm::report);
+    connect(&burstTimer_, &QTimer::timeout, this, &PlayerFarm::burst);
+}
+
+PlayerFarm::~PlayerFarm()
+{
+    for (int i = 0; i < int(players_.size()); i++)
+    {
+        QFile::remove(QDir(options_.desktopDir).filePath(playerName(i) + ".desktop"));
+    }
+}
+
+bool PlayerFarm::writeDesktopFile(int index)
+{
+    QFile file(QDir(options_.desktopDir).filePath(playerName(index) + ".desktop"));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qWarning() << "unable to write" << file.fileName();
+        return false;
+    }
+
+    QTextStream stream(&file);
+    stream << "[Desktop Entry]\n"
+           << "Type=Application\n"
+           << "Name=Farm Player " << index << "\n"
+           << "Exec=true\n"
+           << "Icon=testplayer\n";
+    return true;
+}
+
+bool PlayerFarm::start()
+{
+    if (!QDir().mkpath(options_.desktopDir))
+    {
+        qWarning() << "unable to create" << options_.desktopDir;
+        return false;
+    }
+
+    QDBusConnection session = QDBusConnection::sessionBus();
+
+    QDBusReply<uint> pid = session.interface()->servicePid(INDICATOR_SERVICE);
+    if (pid.isValid())
+    {
+        indicatorPid_ = pid.value();
+    }
+    else
+    {
+        qWarning() << "indicator is not running, CPU time and RSS are not recorded";
+    }
+
+    if (!session.connect(INDICATOR_SERVICE, INDICATOR_PATH, "org.gtk.Actions", "Changed",
+                         this, SLOT(actionsChanged(QDBusMessage))))
+    {
+        qWarning() << "unable to watch the indicator's actions";
+        return false;
+    }
+
+    for (int i = 0; i < options_.players; i++)
+    {
+        if (!writeDesktopFile(i))
+            return false;
+
+        std::unique_ptr<Player> player(new Player(i));
+        if (!player->connection.isConnected())
+        {
+            qWarning() << "unable to connect to the session bus:" << player->connection.lastError().message();
+            return false;
+        }
+
+        player->mock = new MediaPlayerMprisMock(player->name, this, player->connection);
+        Player *p = player.get();
+        connect(player->mock, &MediaPlayerMprisMock::playlistsFetched, this, [this, p](uint playlistCount)
+        {
+            playlistsFetched(p, playlistCount);
+        });
+        new PlayerAdaptor(player->mock);
+        new MediaPlayer2Adaptor(player->mock);
+        new PlaylistsAdaptor(player->mock);
+
+        if (!player->connection.registerObject("/org/mpris/MediaPlayer2", player->mock))
+        {
+            qWarning() << "unable to register player object for" << player->name;
+            return false;
+        }
+
+        player->registered = player->connection.registerService(player->service);
+        players_.push_back(std::move(player));
+    }
+
+    firstSample_ = lastSample_ = sampleIndicator();
+    peakRssKb_ = firstSample_.rssKb;
+
+    clock_.start();
+    tickTimer_.start(TICK_MS);
+    reportTimer_.start(1000);
+    if (options_.burstInterval > 0)
+    {
+        burstTimer_.start(options_.burstInterval * 1000);
+    }
+
+    return true;
+}
+
+void PlayerFarm::tick()
+{
+    if (clock_.elapsed() >= options_.seconds * 1000)
+    {
+        tickTimer_.stop();
+        reportTimer_.stop();
+        burstTimer_.stop();
+
+        // give the indicator a moment to publish the last changes
+        QTimer::singleShot(1000, this, [this]()
+        {
+            printSummary();
+            Q_EMIT finished();
+        });
+        return;
+    }
+
+    pendingMetadata_ += options_.metadataRate * TICK_MS / 1000.0;
+    pendingStatus_ += options_.statusRate * TICK_MS / 1000.0;
+    pendingPlaylists_ += options_.playlistRate * TICK_MS / 1000.0;
+
+    auto nextRegistered = [this]() -> Player *
+    {
+        for (size_t i = 0; i < players_.size(); i++)
+        {
+            Player *player = players_[nextPlayer_].get();
+            nextPlayer_ = (nextPlayer_ + 1) % players_.size();
+            if (player->registered)
+                return player;
+        }
+        return nullptr;
+    };
+
+    for (; pendingMetadata_ >= 1; pendingMetadata_--)
+    {
+        Player *player = nextRegistered();
+        if (!player)
+            break;
+
+        quint64 serial = ++player->serial;
+
+        QVariantMap metadata;
+        metadata["xesam:title"] = trackTitle(player->index, serial);
+        metadata["xesam:artist"] = QStringList() << "Farm";
+        metadata["xesam:album"] = QString("Album %1").arg(serial % 10);
+        metadata["mpris:artUrl"] = QString();
+
+        sent(tracks_, player->pendingTracks, serial, QString());
+        player->mock->setMetadata(metadata);
+    }
+
+    for (; pendingStatus_ >= 1; pendingStatus_--)
+    {
+        Player *player = nextRegistered();
+        if (!player)
+            break;
+
+        QString status = player->playing ? "Paused" : "Playing";
+        player->playing = !player->playing;
+        sent(status_, player->pendingStatus, ++player->serial, status);
+        player->mock->setPlaybackStatus(status);
+    }
+
+    for (; pendingPlaylists_ >= 1; pendingPlaylists_--)
+    {
+        Player *player = nextRegistered();
+        if (!player)
+            break;
+
+        player->playlists = (player->playlists + 1) % 5;
+        sent(playlists_, player->pendingPlaylists, ++player->serial, QString::number(player->playlists));
+        player->mock->setPlaylistCount(player->playlists);
+    }
+}
+
+void PlayerFarm::burst()
+{
+    // make a group of players vanish at once, and come back half an interval later
+    std::vector<Player *> vanished;
+    for (auto const &player : players_)
+    {
+        if (int(vanished.size()) == options_.burstSize)
+            break;
+
+        if (player->registered && player->connection.unregisterService(player->service))
+        {
+            player->registered = false;
+            player->clearPending();
+            vanished.push_back(player.get());
+        }
+    }
+
+    std::rotate(players_.begin(), players_.begin() + std::min<size_t>(options_.burstSize, players_.size()), players_.end());
+    nextPlayer_ = 0;
+
+    QTimer::singleShot(options_.burstInterval * 500, this, [vanished]()
+    {
+        for (Player *player : vanished)
+        {
+            player->registered = player->connection.registerService(player->service);
+        }
+    });
+}
+
+void PlayerFarm::sent(ChangeStats &stats, PendingChanges &pending, quint64 serial, QString const &value)
+{
+    pending.insert(serial, PendingChange{clock_.nsecsElapsed(), value});
+    stats.sent++;
+}
+
+void PlayerFarm::published(ChangeStats &stats, PendingChanges &pending, PendingChanges::iterator change)
+{
+    stats.latenciesMs << (clock_.nsecsElapsed() - change.value().sentNs) / 1e6;
+    stats.published++;
+
+    // earlier changes that were never published have been coalesced with this one
+    while (pending.begin() != change)
+    {
+        pending.erase(pending.begin());
+        stats.coalesced++;
+    }
+    pending.erase(change);
+}
+
+void PlayerFarm::publishedValue(ChangeStats &stats, PendingChanges &pending, QString const &value)
+{
+    // values repeat, the latest change to @value is the one that got published
+    for (auto change = pending.end(); change != pending.begin();)
+    {
+        --change;
+        if (change.value().value == value)
+        {
+            published(stats, pending, change);
+            return;
+        }
+    }
+}
+
+void PlayerFarm::actionsChanged(QDBusMessage const &message)
+{
+    // org.gtk.Actions.Changed (as removals, a{sb} enabled, a{sv} state, a{s(bgav)} added)
+    if (message.arguments().size() < 3)
+        return;
+
+    QVariantMap states = qdbus_cast<QVariantMap>(message.arguments().at(2));
+    for (auto it = states.constBegin(); it != states.constEnd(); ++it)
+    {
+        for (auto const &player : players_)
+        {
+            // the play action's state is the playback status
+            if (it.key() == "play." + player->name + ".desktop")
+            {
+                publishedValue(status_, player->pendingStatus, it.value().toString());
+                break;
+            }
+            if (it.key() != player->name + ".desktop")
+                continue;
+
+            QVariantMap state = qdbus_cast<QVariantMap>(it.value());
+
+            int index;
+            quint64 serial;
+            if (parseTrackTitle(state.value("title").toString(), index, serial) && index == player->index)
+            {
+                auto change = player->pendingTracks.find(serial);
+                if (change != player->pendingTracks.end())
+                    published(tracks_, player->pendingTracks, change);
+            }
+            break;
+        }
+    }
+}
+
+void PlayerFarm::playlistsFetched(Player *player, uint playlistCount)
+{
+    publishedValue(playlists_, player->pendingPlaylists, QString::number(playlistCount));
+}
+
+PlayerFarm::CpuSample PlayerFarm::sampleIndicator() const
+{
+    CpuSample sample;
+    if (indicatorPid_ == 0)
+        return sample;
+
+    QFile stat(QString("/proc/%1/stat").arg(indicatorPid_));
+    if (stat.open(QIODevice::ReadOnly))
+    {
+        // utime and stime are the 14th and 15th fields; the 2nd one may contain spaces
+        QString line = QString::fromLatin1(stat.readAll());
+        QStringList fields = line.mid(line.lastIndexOf(')') + 2).split(' ');
+        if (fields.size() > 12)
+        {
+            double ticks = fields[11].toDouble() + fields[12].toDouble();
+            sample.cpuSeconds = ticks / sysconf(_SC_CLK_TCK);
+        }
+    }
+
+    QFile status(QString("/proc/%1/status").arg(indicatorPid_));
+    if (status.open(QIODevice::ReadOnly))
+    {
+        for (QString line : QString::fromLatin1(status.readAll()).split('\n'))
+        {
+            if (line.startsWith("VmRSS:"))
+            {
+                sample.rssKb = line.mid(6).trimmed().split(' ').first().toLongLong();
+                break;
+            }
+        }
+    }
+
+    return sample;
+}
+
+void PlayerFarm::report()
+{
+    CpuSample sample = sampleIndicator();
+    peakRssKb_ = std::max(peakRssKb_, sample.rssKb);
+
+    int backlog = 0;
+    for (auto const &player : players_)
+    {
+        backlog += player->pendingTracks.size() + player->pendingStatus.size() + player->pendingPlaylists.size();
+    }
+
+    qDebug().nospace() << clock_.elapsed() / 1000 << "s:"
+                       << " cpu " << int(100 * (sample.cpuSeconds - lastSample_.cpuSeconds)) << "%"
+                       << " rss " << sample.rssKb << "kB"
+                       << " published " << tracks_.published << "/" << tracks_.sent << " tracks, "
+                       << status_.published << "/" << status_.sent << " status, "
+                       << playlists_.published << "/" << playlists_.sent << " playlists"
+                       << " backlog " << backlog;
+
+    lastSample_ = sample;
+}
+
+void PlayerFarm::printSummary()
+{
+    CpuSample sample = sampleIndicator();
+    peakRssKb_ = std::max(peakRssKb_, sample.rssKb);
+    double wall = clock_.elapsed() / 1000.0;
+
+    QTextStream out(stdout);
+    out << "players:            " << players_.size() << "\n"
+        << "duration:           " << wall << " s\n";
+    printStats(out, "tracks", tracks_);
+    printStats(out, "playback status", status_);
+    printStats(out, "playlists", playlists_);
+    out << "indicator cpu:      " << (sample.cpuSeconds - firstSample_.cpuSeconds) << " s ("
+                                  << int(100 * (sample.cpuSeconds - firstSample_.cpuSeconds) / wall) << "%)\n"
+        << "indicator rss (kB): start " << firstSample_.rssKb << ", end " << sample.rssKb << ", peak " << peakRssKb_ << "\n";
+}
+
+void PlayerFarm::printStats(QTextStream &out, QString const &name, ChangeStats const &stats)
+{
+    QVector<double> sorted = stats.latenciesMs;
+    std::sort(sorted.begin(), sorted.end());
+
+    out << name << ":\n"
+        << "  changes sent:     " << stats.sent << "\n"
+        << "  published:        " << stats.published << " (" << stats.coalesced << " coalesced, "
+                                  << (stats.sent - stats.published - stats.coalesced) << " missing)\n"
+        << "  latency (ms):     median " << percentile(sorted, 0.5) << ", p95 " << percentile(sorted, 0.95)
+                                  << ", max " << (sorted.isEmpty() ? 0 : sorted.last()) << "\n";
+}
@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <QElapsedTimer>
+#include <QMap>
+#include <QObject>
+#include <QTextStream>
+#include <QTimer>
+#include <QVector>
+
+#include <memory>
+#include <vector>
+
+namespace ubuntu
+{
+
+namespace indicators
+{
+
+namespace testing
+{
+
+class MediaPlayerMprisMock;
+
+/*
+ * Load generator for the sound indicator: hosts a number of mock MPRIS players,
+ * each on its own bus connection, and changes their properties at configurable
+ * rates.  It measures how long the indicator takes to publish each track and
+ * playback status change in its actions, and to fetch the playlists after each
+ * playlist count change, and samples the indicator's CPU time and RSS.
+ */
+class PlayerFarm : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Options
+    {
+        int players = 20;
+        double metadataRate = 50;   // changes per second, over all players
+        double statusRate = 10;
+        double playlistRate = 1;
+        int seconds = 30;
+        int burstInterval = 0;      // seconds, 0 disables bursts
+        int burstSize = 5;
+        QString desktopDir;
+    };
+
+    PlayerFarm(Options const &options, QObject *parent = 0);
+    virtual ~PlayerFarm();
+
+    bool start();
+
+Q_SIGNALS:
+    void finished();
+
+private Q_SLOTS:
+    void actionsChanged(QDBusMessage const &message);
+
+private:
+    struct Player;
+
+    // a change not yet seen in the indicator, with the value it changed to
+    struct PendingChange
+    {
+        qint64 sentNs;
+        QString value;
+    };
+
+    typedef QMap<quint64, PendingChange> PendingChanges;
+
+    struct ChangeStats
+    {
+        quint64 sent = 0;
+        quint64 published = 0;
+        quint64 coalesced = 0;
+        QVector<double> latenciesMs;
+    };
+
+    struct CpuSample
+    {
+        double cpuSeconds = 0;
+        qint64 rssKb = 0;
+    };
+
+    bool writeDesktopFile(int index);
+    void sent(ChangeStats &stats, PendingChanges &pending, quint64 serial, QString const &value);
+    void published(ChangeStats &stats, PendingChanges &pending, PendingChanges::iterator change);
+    void publishedValue(ChangeStats &stats, PendingChanges &pending, QString const &value);
+    void playlistsFetched(Player *player, uint playlistCount);
+    void printStats(QTextStream &out, QString const &name, ChangeStats const &stats);
+    void tick();
+    void burst();
+    void report();
+    void printSummary();
+    CpuSample sampleIndicator() const;
+
+    Options options_;
+    std::vector<std::unique_ptr<Player>> players_;
+    QTimer tickTimer_;
+    QTimer reportTimer_;
+    QTimer burstTimer_;
+    QElapsedTimer clock_;
+
+    double pendingMetadata_ = 0;
+    double pendingStatus_ = 0;
+    double pendingPlaylists_ = 0;
+    int nextPlayer_ = 0;
+
+    uint indicatorPid_ = 0;
+    CpuSample firstSample_;
+    CpuSample lastSample_;
+    qint64 peakRssKb_ = 0;
+
+    ChangeStats tracks_;
+    ChangeStats status_;
+    ChangeStats playlists_;
+};
+
+} // namespace testing
+
+} // namespace indicators
+
+} // namespace ubuntu
@@ -24,26 +24,33 @@
 #include "MediaPlayerMprisMock.h"
 #include "MediaPlayerMprisMockAdaptor.h"
 #include "MediaPlayer2MockAdaptor.h"
+#include "MediaPlayerPlaylistsMockAdaptor.h"
 
 using namespace ubuntu::indicators::testing;
 
 int main(int argc, char *argv[])
 {
-    if (argc != 2)
+    if (argc != 2 && argc != 3)
     {
-        qWarning() << "usage: " << argv[0] << "TEST_PLAYER_NAME";
+        qWarning() << "usage: " << argv[0] << "TEST_PLAYER_NAME [INSTANCE_NAME]";
         return 1;
     }
     QString playerName = QString(argv[1]);
 
     QCoreApplication app(argc, argv);
     QString playerService = QString("org.mpris.MediaPlayer2.") + playerName;
+    if (argc == 3)
+    {
+        // additional instances of a player own names like org.mpris.MediaPlayer2.vlc.instance1234
+        playerService += QString(".") + argv[2];
+    }
     QDBusConnection connection = QDBusConnection::sessionBus();
     if (!connection.interface()->isServiceRegistered(playerService))
     {
         auto service = new MediaPlayerMprisMock(playerName, &app);
         new PlayerAdaptor(service);
         new MediaPlayer2Adaptor(service);
+        new PlaylistsAdaptor(service);
 
         if (!connection.registerService(playerService))
         {
@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <QtCore/QCoreApplication>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QQueue>
+#include <QtCore/QTimer>
+#include <QtDBus/QDBusConnection>
+#include <QtDBus/QDBusConnectionInterface>
+
+#include "MediaPlayerMprisMock.h"
+#include "MediaPlayerMprisMockAdaptor.h"
+#include "MediaPlayer2MockAdaptor.h"
+#include "MediaPlayerPlaylistsMockAdaptor.h"
+
+using namespace ubuntu::indicators::testing;
+
+/*
+ * Stress tool: makes MPRIS bus names appear and vanish at a given rate, as
+ * browsers do when tabs start and stop playing media.  All names are owned by
+ * this process and point to the same mock player object.
+ */
+
+namespace
+{
+constexpr int TICK_MS = 10;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 4 || argc > 5)
+    {
+        qWarning() << "usage: " << argv[0] << "TEST_PLAYER_NAME NAMES_PER_SECOND SECONDS [LIVE_NAMES]";
+        return 1;
+    }
+
+    QCoreApplication app(argc, argv);
+
+    QString playerName = QString(argv[1]);
+    int namesPerSecond = QString(argv[2]).toInt();
+    int seconds = QString(argv[3]).toInt();
+    int liveNames = argc == 5 ? QString(argv[4]).toInt() : 10;
+
+    if (namesPerSecond <= 0 || seconds <= 0 || liveNames <= 0)
+    {
+        qWarning() << argv[0] << ": invalid arguments";
+        return 1;
+    }
+
+    QDBusConnection connection = QDBusConnection::sessionBus();
+
+    auto service = new MediaPlayerMprisMock(playerName, &app);
+    new PlayerAdaptor(service);
+    new MediaPlayer2Adaptor(service);
+    new PlaylistsAdaptor(service);
+
+    if (!connection.registerObject("/org/mpris/MediaPlayer2", service))
+    {
+        qFatal("Could not register MediaPlayerMprisMock object.");
+    }
+
+    QString prefix = QString("org.mpris.MediaPlayer2.%1.instance%2_").arg(playerName).arg(app.applicationPid());
+    QQueue<QString> live;
+    int serial = 0;
+    int failures = 0;
+    double pending = 0;
+
+    QElapsedTimer elapsed;
+    elapsed.start();
+
+    QTimer timer;
+    QObject::connect(&timer, &QTimer::timeout, [&]()
+    {
+        if (elapsed.elapsed() >= seconds * 1000)
+        {
+            timer.stop();
+            while (!live.isEmpty())
+            {
+                connection.unregisterService(live.dequeue());
+            }
+            qDebug() << "registered" << serial << "names in" << elapsed.elapsed() << "ms," << failures << "failures";
+            app.exit(failures == 0 ? 0 : 1);
+            return;
+        }
+
+        pending += namesPerSecond * TICK_MS / 1000.0;
+        for (; pending >= 1; pending--)
+        {
+            QString name = prefix + QString::number(serial++);
+            if (connection.registerService(name))
+            {
+                live.enqueue(name);
+            }
+            else
+            {
+                failures++;
+            }
+
+            if (live.size() > liveNames)
+            {
+                connection.unregisterService(live.dequeue());
+            }
+        }
+    });
+    timer.start(TICK_MS);
+
+    return app.exec();
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <QtCore/QCommandLineParser>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDebug>
+#include <QtCore/QStandardPaths>
+
+#include "PlayerFarm.h"
+
+using namespace ubuntu::indicators::testing;
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Hosts many mock MPRIS players and changes their properties "
+                                     "at the given rates, to measure how the sound indicator keeps up.\n"
+                                     "The indicator must already be running, and must search DESKTOP_DIR "
+                                     "for desktop files (it does with the default).");
+    parser.addHelpOption();
+
+    QCommandLineOption playersOption("players", "Number of players.", "N", "20");
+    QCommandLineOption metadataOption("metadata-rate", "Track changes per second, over all players.", "RATE", "50");
+    QCommandLineOption statusOption("status-rate", "Playback status changes per second, over all players.", "RATE", "10");
+    QCommandLineOption playlistOption("playlist-rate", "Playlist count changes per second, over all players.", "RATE", "1");
+    QCommandLineOption secondsOption("seconds", "Duration of the run.", "SECONDS", "30");
+    QCommandLineOption burstIntervalOption("burst-interval", "Make players vanish in bursts every SECONDS (0 disables bursts).", "SECONDS", "0");
+    QCommandLineOption burstSizeOption("burst-size", "Number of players that vanish in a burst.", "N", "5");
+    QCommandLineOption desktopDirOption("desktop-dir", "Directory for the players' desktop files.", "DESKTOP_DIR",
+                                        QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + "/applications");
+
+    parser.addOptions({playersOption, metadataOption, statusOption, playlistOption,
+                       secondsOption, burstIntervalOption, burstSizeOption, desktopDirOption});
+    parser.process(app);
+
+    PlayerFarm::Options options;
+    options.players = parser.value(playersOption).toInt();
+    options.metadataRate = parser.value(metadataOption).toDouble();
+    options.statusRate = parser.value(statusOption).toDouble();
+    options.playlistRate = parser.value(playlistOption).toDouble();
+    options.seconds = parser.value(secondsOption).toInt();
+    options.burstInterval = parser.value(burstIntervalOption).toInt();
+    options.burstSize = parser.value(burstSizeOption).toInt();
+    options.desktopDir = parser.value(desktopDirOption);
+
+    if (options.players <= 0 || options.seconds <= 0)
+    {
+        qWarning() << argv[0] << ": invalid arguments";
+        return 1;
+    }
+
+    PlayerFarm farm(options);
+    QObject::connect(&farm, &PlayerFarm::finished, &app, &QCoreApplication::quit);
+
+    if (!farm.start())
+    {
+        return 1;
+    }
+
+    return app.exec();
+}
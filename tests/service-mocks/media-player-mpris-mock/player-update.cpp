@@ -27,6 +27,7 @@ QMap<QString, QString> getPropertiesMap()
     retMap["CANPAUSE"] = "setCanPause";
     retMap["CANGONEXT"] = "setCanGoNext";
     retMap["CANGOPREVIOUS"] = "setCanGoPrevious";
+    retMap["PLAYLISTCOUNT"] = "setPlaylistCount";
 
     return retMap;
 }
@@ -52,7 +53,7 @@ int main(int argc, char **argv)
 
     if (argc != 4)
     {
-        qStdErr() << "usage: " << argv[0] << "TEST_PLAYER_NAME  PropertyName true|false\n";
+        qStdErr() << "usage: " << argv[0] << "TEST_PLAYER_NAME  PropertyName true|false|count\n";
         return 1;
     }
 
@@ -79,8 +80,10 @@ int main(int argc, char **argv)
         return 1;
     }
 
-    QDBusReply<void> set_prop = iface->call(QLatin1String((*iter).toStdString().c_str()),
-                                QVariant::fromValue(getBoolValue(state)));
+    // PlaylistCount is the only property that isn't a boolean
+    QVariant value = property == "PLAYLISTCOUNT" ? QVariant::fromValue(state.toUInt())
+                                                 : QVariant::fromValue(getBoolValue(state));
+    QDBusReply<void> set_prop = iface->call(QLatin1String((*iter).toStdString().c_str()), value);
 
     if (!set_prop.isValid())
     {
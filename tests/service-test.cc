@@ -0,0 +1,241 @@
+/*
+ * Copyright 2016 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <memory>
+
+#include <gtest/gtest.h>
+#include <gio/gio.h>
+#include <libdbustest/dbus-test.h>
+#include <libnotify/notify.h>
+
+#include "gtest-gvariant.h"
+
+extern "C" {
+#include "indicator-sound-service.h"
+#include "vala-mocks.h"
+}
+
+class ServiceTest : public ::testing::Test
+{
+    protected:
+        DbusTestService * service = NULL;
+
+        GDBusConnection * session = NULL;
+
+        virtual void SetUp() {
+            g_setenv("GSETTINGS_SCHEMA_DIR", SCHEMA_DIR, TRUE);
+            g_setenv("GSETTINGS_BACKEND", "memory", TRUE);
+
+            service = dbus_test_service_new(NULL);
+            dbus_test_service_set_bus(service, DBUS_TEST_SERVICE_BUS_SESSION);
+            dbus_test_service_start_tasks(service);
+
+            session = g_bus_get_sync(G_BUS_TYPE_SESSION, NULL, NULL);
+            ASSERT_NE(nullptr, session);
+            g_dbus_connection_set_exit_on_close(session, FALSE);
+            g_object_add_weak_pointer(G_OBJECT(session), (gpointer *)&session);
+
+            /* This is done in main.c */
+            notify_init("indicator-sound");
+        }
+
+        virtual void TearDown() {
+            if (notify_is_initted())
+                notify_uninit();
+
+            g_clear_object(&service);
+
+            g_object_unref(session);
+
+            unsigned int cleartry = 0;
+            while (session != NULL && cleartry < 100) {
+                loop(100);
+                cleartry++;
+            }
+
+            ASSERT_EQ(nullptr, session);
+        }
+
+        static gboolean timeout_cb (gpointer user_data) {
+            GMainLoop * loop = static_cast<GMainLoop *>(user_data);
+            g_main_loop_quit(loop);
+            return G_SOURCE_REMOVE;
+        }
+
+        void loop (unsigned int ms) {
+            GMainLoop * loop = g_main_loop_new(NULL, FALSE);
+            g_timeout_add(ms, timeout_cb, loop);
+            g_main_loop_run(loop);
+            g_main_loop_unref(loop);
+        }
+
+        std::shared_ptr<MediaPlayerList> playerListMock () {
+            auto playerList = std::shared_ptr<MediaPlayerList>(
+                MEDIA_PLAYER_LIST(media_player_list_mock_new()),
+                [](MediaPlayerList * list) {
+                    g_clear_object(&list);
+                });
+            return playerList;
+        }
+
+        std::shared_ptr<IndicatorSoundOptions> optionsMock () {
+            auto options = std::shared_ptr<IndicatorSoundOptions>(
+                INDICATOR_SOUND_OPTIONS(options_mock_new()),
+                [](IndicatorSoundOptions * options){
+                    g_clear_object(&options);
+                });
+            return options;
+        }
+
+        std::shared_ptr<VolumeControl> volumeControlMock (const std::shared_ptr<IndicatorSoundOptions>& optionsMock) {
+            auto volumeControl = std::shared_ptr<VolumeControl>(
+                VOLUME_CONTROL(volume_control_mock_new(optionsMock.get())),
+                [](VolumeControl * control){
+                    g_clear_object(&control);
+                });
+            return volumeControl;
+        }
+
+        std::shared_ptr<VolumeWarning> volumeWarningMock (const std::shared_ptr<IndicatorSoundOptions>& optionsMock) {
+            auto volumeWarning = std::shared_ptr<VolumeWarning>(
+                VOLUME_WARNING(volume_warning_mock_new(optionsMock.get())),
+                [](VolumeWarning * warning){
+                    g_clear_object(&warning);
+                });
+            return volumeWarning;
+        }
+
+        std::shared_ptr<IndicatorSoundService> standardService (
+                const std::shared_ptr<VolumeControl>& volumeControl,
+                const std::shared_ptr<MediaPlayerList>& playerList,
+                const std::shared_ptr<IndicatorSoundOptions>& options,
+                const std::shared_ptr<VolumeWarning>& warning,
+                const std::shared_ptr<AccountsServiceAccess>& accounts_service_access) {
+            auto soundService = std::shared_ptr<IndicatorSoundService>(
+                indicator_sound_service_new(playerList.get(), volumeControl.get(), nullptr, options.get(), warning.get(), accounts_service_access.get()),
+                [](IndicatorSoundService * service){
+                    g_clear_object(&service);
+                });
+
+            return soundService;
+        }
+};
+
+static void
+count_state_changes (GActionGroup * group, const gchar * name, GVariant * state, gpointer user_data)
+{
+    (*static_cast<int *>(user_data))++;
+}
+
+TEST_F(ServiceTest, PlayerPositionChanges) {
+    auto options = optionsMock();
+    auto volumeControl = volumeControlMock(options);
+    auto volumeWarning = volumeWarningMock(options);
+    auto accountsService = std::make_shared<AccountsServiceAccess>();
+    auto playerList = playerListMock();
+    auto soundService = standardService(volumeControl, playerList, options, volumeWarning, accountsService);
+
+    MediaPlayerTrack * track = media_player_track_new("Artist", "Title", "Album", "http://art.url");
+    MediaPlayerMock * media = MEDIA_PLAYER_MOCK(
+        g_object_new(TYPE_MEDIA_PLAYER_MOCK,
+            "mock-id", "player-id",
+            "mock-name", "Test Player",
+            "mock-state", "Playing",
+            "mock-is-running", TRUE,
+            "mock-current-track", track,
+            "mock-position", G_GINT64_CONSTANT(1000000),
+            "mock-position-time", g_get_monotonic_time(),
+            NULL)
+    );
+    g_signal_emit_by_name(playerList.get(), "player-added", media);
+
+    MediaPlayerMock * other = MEDIA_PLAYER_MOCK(
+        g_object_new(TYPE_MEDIA_PLAYER_MOCK,
+            "mock-id", "other-id",
+            "mock-name", "Other Player",
+            "mock-state", "Playing",
+            "mock-is-running", TRUE,
+            "mock-current-track", track,
+            "mock-position", G_GINT64_CONSTANT(2000000),
+            "mock-position-time", g_get_monotonic_time(),
+            NULL)
+    );
+    g_clear_object(&track);
+    g_signal_emit_by_name(playerList.get(), "player-added", other);
+
+    GDBusActionGroup * actions = g_dbus_action_group_get(session, g_dbus_connection_get_unique_name(session), "/com/canonical/indicator/sound");
+    g_strfreev(g_action_group_list_actions(G_ACTION_GROUP(actions)));
+    loop(100);
+
+    /* Progress is only published while the menu is open */
+    GVariant * state = g_action_group_get_action_state(G_ACTION_GROUP(actions), "player-id");
+    ASSERT_NE(nullptr, state);
+    EXPECT_EQ(nullptr, g_variant_lookup_value(state, "position", nullptr));
+    g_variant_unref(state);
+
+    g_action_group_change_action_state(G_ACTION_GROUP(actions), "indicator-shown", g_variant_new_boolean(TRUE));
+    loop(100);
+
+    int state_changes = 0;
+    int other_state_changes = 0;
+    g_signal_connect(actions, "action-state-changed::player-id", G_CALLBACK(count_state_changes), &state_changes);
+    g_signal_connect(actions, "action-state-changed::other-id", G_CALLBACK(count_state_changes), &other_state_changes);
+
+    /* Clients extrapolate the position themselves, nothing is republished while playing */
+    loop(2500);
+    EXPECT_EQ(0, state_changes);
+
+    state = g_action_group_get_action_state(G_ACTION_GROUP(actions), "player-id");
+    ASSERT_NE(nullptr, state);
+    EXPECT_GVARIANT_EQ("@x 1000000", g_variant_lookup_value(state, "position", nullptr));
+    EXPECT_GVARIANT_EQ("@d 1.0", g_variant_lookup_value(state, "rate", nullptr));
+    g_variant_unref(state);
+
+    /* A seek does republish it, but only for the player that seeked */
+    gint64 seek_time = g_get_monotonic_time();
+    g_object_set(media,
+        "mock-position", G_GINT64_CONSTANT(5000000),
+        "mock-position-time", seek_time,
+        NULL);
+    g_signal_emit_by_name(media, "position-changed");
+    loop(100);
+    EXPECT_LT(0, state_changes);
+    EXPECT_EQ(0, other_state_changes);
+
+    state = g_action_group_get_action_state(G_ACTION_GROUP(actions), "player-id");
+    ASSERT_NE(nullptr, state);
+    EXPECT_GVARIANT_EQ("@x 5000000", g_variant_lookup_value(state, "position", nullptr));
+    GVariant * position_time = g_variant_lookup_value(state, "position-time", G_VARIANT_TYPE_INT64);
+    ASSERT_NE(nullptr, position_time);
+    EXPECT_EQ(seek_time, g_variant_get_int64(position_time));
+    g_variant_unref(position_time);
+    g_variant_unref(state);
+
+    /* And closing the menu takes it away again */
+    g_action_group_change_action_state(G_ACTION_GROUP(actions), "indicator-shown", g_variant_new_boolean(FALSE));
+    loop(100);
+
+    state = g_action_group_get_action_state(G_ACTION_GROUP(actions), "player-id");
+    ASSERT_NE(nullptr, state);
+    EXPECT_EQ(nullptr, g_variant_lookup_value(state, "position", nullptr));
+    g_variant_unref(state);
+
+    g_signal_emit_by_name(playerList.get(), "player-removed", media);
+    g_signal_emit_by_name(playerList.get(), "player-removed", other);
+    g_object_unref(actions);
+    g_object_unref(media);
+    g_object_unref(other);
+}
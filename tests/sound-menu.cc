@@ -17,6 +17,9 @@
  *      Ted Gould <ted@canonical.com>
  */
 
+#include <string>
+#include <vector>
+
 #include <gtest/gtest.h>
 #include <gio/gio.h>
 
@@ -183,6 +186,576 @@ TEST_F(SoundMenuTest, AddRemovePlayer) {
     return;
 }
 
+TEST_F(SoundMenuTest, ManyPlayersBenchmark) {
+    const int n_players = 50;
+    const int n_changes = 100;
+
+    SoundMenu * menu = sound_menu_new ("indicator.settings", SOUND_MENU_DISPLAY_FLAGS_NONE);
+    std::vector<MediaPlayerMock *> players;
+
+    for (int i = 0; i < n_players; i++) {
+        gchar * id = g_strdup_printf("player%d", i);
+        MediaPlayerMock * media = MEDIA_PLAYER_MOCK(
+            g_object_new(TYPE_MEDIA_PLAYER_MOCK,
+                "mock-id", id,
+                "mock-name", "Test Player",
+                "mock-state", "Playing",
+                "mock-is-running", TRUE,
+                "mock-can-raise", FALSE,
+                "mock-can-do-play", TRUE,
+                NULL)
+        );
+        g_free(id);
+
+        sound_menu_add_player(menu, MEDIA_PLAYER(media));
+        players.push_back(media);
+    }
+
+    /* Volume section, one section per player and the settings item */
+    ASSERT_EQ(n_players + 2, g_menu_model_get_n_items(G_MENU_MODEL(menu->menu)));
+
+    /* Every playback status change looks up the player's section */
+    gint64 start = g_get_monotonic_time();
+    for (int i = 0; i < n_changes; i++) {
+        for (auto media : players)
+            g_signal_emit_by_name(media, "playbackstatus-changed");
+    }
+    g_print("%d section lookups with %d players in %" G_GINT64_FORMAT " ms\n", n_changes * n_players, n_players,
+            (g_get_monotonic_time() - start) / 1000);
+
+    /* Sections after a removed one are still found */
+    sound_menu_remove_player(menu, MEDIA_PLAYER(players[10]));
+    g_clear_object(&players[10]);
+    players.erase(players.begin() + 10);
+
+    ASSERT_EQ(n_players + 1, g_menu_model_get_n_items(G_MENU_MODEL(menu->menu)));
+
+    GMenuModel * section = g_menu_model_get_item_link(G_MENU_MODEL(menu->menu), 10, G_MENU_LINK_SECTION);
+    ASSERT_NE(nullptr, section);
+    verify_item_attribute(section, 0, "action", g_variant_new_string("indicator.player11"));
+    g_clear_object(&section);
+
+    sound_menu_remove_player(menu, MEDIA_PLAYER(players.back()));
+    EXPECT_EQ(n_players, g_menu_model_get_n_items(G_MENU_MODEL(menu->menu)));
+
+    section = g_menu_model_get_item_link(G_MENU_MODEL(menu->menu), n_players - 2, G_MENU_LINK_SECTION);
+    ASSERT_NE(nullptr, section);
+    verify_item_attribute(section, 0, "action", g_variant_new_string("indicator.player48"));
+    g_clear_object(&section);
+
+    for (auto media : players)
+        g_clear_object(&media);
+    g_clear_object(&menu);
+}
+
+static void
+count_items_changed (GMenuModel * model, gint position, gint removed, gint added, gpointer user_data)
+{
+    (*static_cast<int *>(user_data))++;
+}
+
+TEST_F(SoundMenuTest, PlayerStartTouchesOnlyAffectedSections) {
+    const int n_players = 10;
+
+    SoundMenu * menu = sound_menu_new (nullptr, SOUND_MENU_DISPLAY_FLAGS_HIDE_INACTIVE_PLAYERS_PLAY_CONTROLS);
+    std::vector<MediaPlayerMock *> players;
+
+    for (int i = 0; i < n_players; i++) {
+        gchar * id = g_strdup_printf("player%d", i);
+        MediaPlayerMock * media = MEDIA_PLAYER_MOCK(
+            g_object_new(TYPE_MEDIA_PLAYER_MOCK,
+                "mock-id", id,
+                "mock-name", "Test Player",
+                "mock-state", "Paused",
+                "mock-is-running", FALSE,
+                "mock-can-raise", FALSE,
+                "mock-can-do-play", TRUE,
+                NULL)
+        );
+        g_free(id);
+
+        sound_menu_add_player(menu, MEDIA_PLAYER(media));
+        players.push_back(media);
+    }
+
+    /* The default player shows its controls while nothing runs */
+    sound_menu_set_default_player(menu, "player9");
+
+    /* Start half of the players */
+    for (int i = 0; i < n_players / 2; i++) {
+        g_object_set(players[i], "mock-is-running", TRUE, NULL);
+        g_object_notify(G_OBJECT(players[i]), "is-running");
+    }
+
+    std::vector<int> changes(n_players, 0);
+    std::vector<GMenuModel *> sections;
+    for (int i = 0; i < n_players; i++) {
+        GMenuModel * section = g_menu_model_get_item_link(G_MENU_MODEL(menu->menu), i + 1, G_MENU_LINK_SECTION);
+        ASSERT_NE(nullptr, section);
+        g_signal_connect(section, "items-changed", G_CALLBACK(count_items_changed), &changes[i]);
+        sections.push_back(section);
+    }
+
+    /* The default player lost its controls when the first player started */
+    EXPECT_EQ(1, g_menu_model_get_n_items(sections[n_players - 1]));
+
+    /* Starting one more player only touches its own section */
+    g_object_set(players[n_players / 2], "mock-is-running", TRUE, NULL);
+    g_object_notify(G_OBJECT(players[n_players / 2]), "is-running");
+
+    for (int i = 0; i < n_players; i++) {
+        if (i == n_players / 2)
+            EXPECT_LT(0, changes[i]);
+        else
+            EXPECT_EQ(0, changes[i]) << "section of player" << i;
+    }
+    EXPECT_EQ(2, g_menu_model_get_n_items(sections[n_players / 2]));
+
+    for (int i = 0; i < n_players; i++)
+        g_signal_handlers_disconnect_by_func(sections[i], (gpointer) count_items_changed, &changes[i]);
+    for (auto section : sections)
+        g_object_unref(section);
+    for (auto media : players)
+        g_clear_object(&media);
+    g_clear_object(&menu);
+}
+
+TEST_F(SoundMenuTest, VolumeSliderRelabel) {
+    SoundMenu * menu = sound_menu_new (nullptr, SOUND_MENU_DISPLAY_FLAGS_SHOW_MUTE);
+
+    GMenuModel * section = g_menu_model_get_item_link(G_MENU_MODEL(menu->menu), 0, G_MENU_LINK_SECTION);
+    ASSERT_NE(nullptr, section);
+    ASSERT_EQ(2, g_menu_model_get_n_items(section));
+    verify_item_attribute(section, 1, "label", g_variant_new_string("Volume"));
+
+    int changes = 0;
+    g_signal_connect(section, "items-changed", G_CALLBACK(count_items_changed), &changes);
+
+    /* Same label, nothing changes */
+    sound_menu_update_volume_slider(menu, VOLUME_CONTROL_ACTIVE_OUTPUT_SPEAKERS);
+    sound_menu_update_volume_slider(menu, VOLUME_CONTROL_ACTIVE_OUTPUT_CALL_MODE);
+    EXPECT_EQ(0, changes);
+
+    /* A new label replaces the slider in a single change */
+    sound_menu_update_volume_slider(menu, VOLUME_CONTROL_ACTIVE_OUTPUT_HEADPHONES);
+    EXPECT_EQ(1, changes);
+    EXPECT_EQ(2, g_menu_model_get_n_items(section));
+    verify_item_attribute(section, 1, "label", g_variant_new_string("Volume (Headphones)"));
+    verify_item_attribute(section, 1, "action", g_variant_new_string("indicator.volume"));
+    verify_item_attribute(section, 1, "x-canonical-type", g_variant_new_string("com.canonical.unity.slider"));
+
+    sound_menu_update_volume_slider(menu, VOLUME_CONTROL_ACTIVE_OUTPUT_HEADPHONES);
+    EXPECT_EQ(1, changes);
+
+    sound_menu_update_volume_slider(menu, VOLUME_CONTROL_ACTIVE_OUTPUT_SPEAKERS);
+    EXPECT_EQ(2, changes);
+    verify_item_attribute(section, 1, "label", g_variant_new_string("Volume"));
+
+    g_signal_handlers_disconnect_by_func(section, (gpointer) count_items_changed, &changes);
+    g_object_unref(section);
+    g_clear_object(&menu);
+}
+
+TEST_F(SoundMenuTest, SharedAttributeValues) {
+    SoundMenu * desktop = sound_menu_new (nullptr, SOUND_MENU_DISPLAY_FLAGS_SHOW_MUTE);
+    SoundMenu * phone = sound_menu_new (nullptr, SOUND_MENU_DISPLAY_FLAGS_NONE);
+
+    GMenuModel * desktop_section = g_menu_model_get_item_link(G_MENU_MODEL(desktop->menu), 0, G_MENU_LINK_SECTION);
+    GMenuModel * phone_section = g_menu_model_get_item_link(G_MENU_MODEL(phone->menu), 0, G_MENU_LINK_SECTION);
+    ASSERT_NE(nullptr, desktop_section);
+    ASSERT_NE(nullptr, phone_section);
+
+    /* The volume sliders of both menus share their attribute values */
+    const gchar * names[] = { "x-canonical-type", "min-icon", "max-icon", "min-value", "max-value", "step" };
+    for (auto name : names) {
+        GVariant * desktop_value = g_menu_model_get_item_attribute_value(desktop_section, 1, name, nullptr);
+        GVariant * phone_value = g_menu_model_get_item_attribute_value(phone_section, 0, name, nullptr);
+
+        ASSERT_NE(nullptr, desktop_value);
+        EXPECT_EQ(desktop_value, phone_value) << name;
+
+        g_variant_unref(desktop_value);
+        g_variant_unref(phone_value);
+    }
+
+    verify_item_attribute(phone_section, 0, "min-value", g_variant_new_double(0.0));
+    verify_item_attribute(phone_section, 0, "max-value", g_variant_new_double(1.0));
+
+    g_object_unref(desktop_section);
+    g_object_unref(phone_section);
+    g_clear_object(&desktop);
+    g_clear_object(&phone);
+}
+
+struct ItemChanges {
+    int count = 0;
+    int removed = 0;
+    int added = 0;
+};
+
+static void
+record_items_changed (GMenuModel * model, gint position, gint removed, gint added, gpointer user_data)
+{
+    auto changes = static_cast<ItemChanges *>(user_data);
+    changes->count++;
+    changes->removed += removed;
+    changes->added += added;
+}
+
+static void
+set_mock_playlists (MediaPlayerMock * media, const std::vector<std::string> & ids, const std::vector<std::string> & names)
+{
+    std::vector<const gchar *> id_strv, name_strv;
+    for (auto & id : ids)
+        id_strv.push_back(id.c_str());
+    for (auto & name : names)
+        name_strv.push_back(name.c_str());
+    id_strv.push_back(nullptr);
+    name_strv.push_back(nullptr);
+
+    g_object_set(media,
+        "mock-playlist-ids", id_strv.data(),
+        "mock-playlist-names", name_strv.data(),
+        NULL);
+    g_signal_emit_by_name(media, "playlists-changed");
+}
+
+TEST_F(SoundMenuTest, PlaylistDiffBenchmark) {
+    const int n_playlists = 500;
+    const int n_changes = 100;
+
+    SoundMenu * menu = sound_menu_new (nullptr, SOUND_MENU_DISPLAY_FLAGS_NONE);
+
+    MediaPlayerMock * media = MEDIA_PLAYER_MOCK(
+        g_object_new(TYPE_MEDIA_PLAYER_MOCK,
+            "mock-id", "player-id",
+            "mock-name", "Test Player",
+            "mock-state", "Playing",
+            "mock-is-running", TRUE,
+            "mock-can-raise", FALSE,
+            "mock-can-do-play", TRUE,
+            NULL)
+    );
+    sound_menu_add_player(menu, MEDIA_PLAYER(media));
+
+    std::vector<std::string> ids, names;
+    for (int i = 0; i < n_playlists; i++) {
+        ids.push_back("/playlist/" + std::to_string(i));
+        names.push_back("Playlist " + std::to_string(i));
+    }
+    set_mock_playlists(media, ids, names);
+
+    GMenuModel * section = g_menu_model_get_item_link(G_MENU_MODEL(menu->menu), 1, G_MENU_LINK_SECTION);
+    ASSERT_NE(nullptr, section);
+    ASSERT_EQ(3, g_menu_model_get_n_items(section));
+
+    GMenuModel * submenu = g_menu_model_get_item_link(section, 2, G_MENU_LINK_SUBMENU);
+    ASSERT_NE(nullptr, submenu);
+    GMenuModel * playlists = g_menu_model_get_item_link(submenu, 0, G_MENU_LINK_SECTION);
+    ASSERT_NE(nullptr, playlists);
+    ASSERT_EQ(n_playlists, g_menu_model_get_n_items(playlists));
+    verify_item_attribute(playlists, 7, "label", g_variant_new_string("Playlist 7"));
+    verify_item_attribute(playlists, 7, "target", g_variant_new_string("/playlist/7"));
+
+    int section_changes = 0;
+    g_signal_connect(section, "items-changed", G_CALLBACK(count_items_changed), &section_changes);
+    ItemChanges changes;
+    g_signal_connect(playlists, "items-changed", G_CALLBACK(record_items_changed), &changes);
+
+    /* Renaming a playlist touches only its item */
+    gint64 start = g_get_monotonic_time();
+    for (int i = 0; i < n_changes; i++) {
+        names[i * 3] = "Renamed " + std::to_string(i);
+        set_mock_playlists(media, ids, names);
+    }
+    g_print("%d single playlist renames with %d playlists in %" G_GINT64_FORMAT " ms\n", n_changes, n_playlists,
+            (g_get_monotonic_time() - start) / 1000);
+
+    EXPECT_EQ(0, section_changes);
+    EXPECT_EQ(n_changes, changes.count);
+    EXPECT_EQ(n_changes, changes.removed);
+    EXPECT_EQ(n_changes, changes.added);
+    verify_item_attribute(playlists, 3, "label", g_variant_new_string("Renamed 1"));
+
+    /* So does adding or removing one */
+    changes = ItemChanges();
+    ids.insert(ids.begin() + 100, "/playlist/new");
+    names.insert(names.begin() + 100, "New Playlist");
+    set_mock_playlists(media, ids, names);
+    EXPECT_EQ(1, changes.count);
+    EXPECT_EQ(0, changes.removed);
+    EXPECT_EQ(1, changes.added);
+    verify_item_attribute(playlists, 100, "target", g_variant_new_string("/playlist/new"));
+
+    changes = ItemChanges();
+    ids.erase(ids.begin() + 10);
+    names.erase(names.begin() + 10);
+    set_mock_playlists(media, ids, names);
+    EXPECT_EQ(1, changes.count);
+    EXPECT_EQ(1, changes.removed);
+    EXPECT_EQ(0, changes.added);
+
+    /* A reordering ends up in the same order as the player's */
+    std::swap(ids[0], ids[5]);
+    std::swap(names[0], names[5]);
+    set_mock_playlists(media, ids, names);
+    ASSERT_EQ(n_playlists, g_menu_model_get_n_items(playlists));
+    for (int i = 0; i < 12; i++)
+        verify_item_attribute(playlists, i, "target", g_variant_new_string(ids[i].c_str()));
+
+    g_signal_handlers_disconnect_by_func(playlists, (gpointer) record_items_changed, &changes);
+    g_signal_handlers_disconnect_by_func(section, (gpointer) count_items_changed, &section_changes);
+
+    /* Without playlists, the submenu goes away */
+    set_mock_playlists(media, {}, {});
+    EXPECT_EQ(2, g_menu_model_get_n_items(section));
+
+    g_object_unref(playlists);
+    g_object_unref(submenu);
+    g_object_unref(section);
+
+    sound_menu_remove_player(menu, MEDIA_PLAYER(media));
+    g_clear_object(&media);
+    g_clear_object(&menu);
+}
+
+TEST_F(SoundMenuTest, SectionUpdateIsOneChange) {
+    SoundMenu * menu = sound_menu_new (nullptr, SOUND_MENU_DISPLAY_FLAGS_NONE);
+
+    MediaPlayerMock * media = MEDIA_PLAYER_MOCK(
+        g_object_new(TYPE_MEDIA_PLAYER_MOCK,
+            "mock-id", "player-id",
+            "mock-name", "Test Player",
+            "mock-state", "Playing",
+            "mock-is-running", TRUE,
+            "mock-can-raise", FALSE,
+            "mock-can-do-play", TRUE,
+            NULL)
+    );
+
+    int menu_changes = 0;
+    g_signal_connect(menu->menu, "items-changed", G_CALLBACK(count_items_changed), &menu_changes);
+
+    sound_menu_add_player(menu, MEDIA_PLAYER(media));
+    EXPECT_EQ(1, menu_changes);
+
+    GMenuModel * section = g_menu_model_get_item_link(G_MENU_MODEL(menu->menu), 1, G_MENU_LINK_SECTION);
+    ASSERT_NE(nullptr, section);
+
+    /* Rebuilding the playback controls is a remove and an insert, seen as one change */
+    int section_changes = 0;
+    g_signal_connect(section, "items-changed", G_CALLBACK(count_items_changed), &section_changes);
+
+    g_object_set(media, "mock-can-do-next", TRUE, NULL);
+    g_signal_emit_by_name(media, "playbackstatus-changed");
+    EXPECT_EQ(1, section_changes);
+    EXPECT_EQ(2, g_menu_model_get_n_items(section));
+    verify_item_attribute(section, 1, "x-canonical-next-action", g_variant_new_string("indicator.next.player-id"));
+
+    g_signal_handlers_disconnect_by_func(section, (gpointer) count_items_changed, &section_changes);
+    g_signal_handlers_disconnect_by_func(menu->menu, (gpointer) count_items_changed, &menu_changes);
+    g_object_unref(section);
+
+    sound_menu_remove_player(menu, MEDIA_PLAYER(media));
+
+    g_clear_object(&media);
+    g_clear_object(&menu);
+}
+
+/* Reads new sections when their parent changes, like a menu exporter does */
+struct SectionReader {
+    GMenuModel * section = nullptr;
+    int n_items_read = -1;
+    int section_changes = 0;
+};
+
+static void
+read_new_sections (GMenuModel * model, gint position, gint removed, gint added, gpointer user_data)
+{
+    auto reader = static_cast<SectionReader *>(user_data);
+    for (int i = position; i < position + added; i++) {
+        GMenuModel * section = g_menu_model_get_item_link(model, i, G_MENU_LINK_SECTION);
+        if (section == nullptr || reader->section != nullptr) {
+            g_clear_object(&section);
+            continue;
+        }
+
+        reader->section = section;
+        reader->n_items_read = g_menu_model_get_n_items(section);
+        g_signal_connect(section, "items-changed", G_CALLBACK(count_items_changed), &reader->section_changes);
+    }
+}
+
+TEST_F(SoundMenuTest, SectionsChangeBeforeTheirParent) {
+    SoundMenu * menu = sound_menu_new (nullptr, SOUND_MENU_DISPLAY_FLAGS_HIDE_INACTIVE_PLAYERS);
+
+    MediaPlayerMock * media = MEDIA_PLAYER_MOCK(
+        g_object_new(TYPE_MEDIA_PLAYER_MOCK,
+            "mock-id", "player-id",
+            "mock-name", "Test Player",
+            "mock-state", "Paused",
+            "mock-is-running", FALSE,
+            "mock-can-raise", FALSE,
+            "mock-can-do-play", TRUE,
+            NULL)
+    );
+    sound_menu_add_player(menu, MEDIA_PLAYER(media));
+    ASSERT_EQ(1, g_menu_model_get_n_items(G_MENU_MODEL(menu->menu)));
+
+    SectionReader reader;
+    g_signal_connect(menu->menu, "items-changed", G_CALLBACK(read_new_sections), &reader);
+
+    /* The player section is created and filled in one transaction.  Whoever
+     * reads it when the parent changes sees all of it, and isn't told about
+     * those items again. */
+    g_object_set(media, "mock-is-running", TRUE, NULL);
+    g_object_notify(G_OBJECT(media), "is-running");
+
+    ASSERT_NE(nullptr, reader.section);
+    EXPECT_EQ(2, reader.n_items_read);
+    EXPECT_EQ(0, reader.section_changes);
+    EXPECT_EQ(2, g_menu_model_get_n_items(reader.section));
+
+    g_signal_handlers_disconnect_by_func(menu->menu, (gpointer) read_new_sections, &reader);
+    g_signal_handlers_disconnect_by_func(reader.section, (gpointer) count_items_changed, &reader.section_changes);
+    g_clear_object(&reader.section);
+
+    sound_menu_remove_player(menu, MEDIA_PLAYER(media));
+    g_clear_object(&media);
+    g_clear_object(&menu);
+}
+
+/* The player lifecycle of the test-indicator integration scenarios, on the desktop menu */
+TEST_F(SoundMenuTest, PlayerLifecycleSignalCount) {
+    SoundMenu * menu = sound_menu_new ("indicator.desktop-settings",
+        (SoundMenuDisplayFlags) (SOUND_MENU_DISPLAY_FLAGS_SHOW_MUTE |
+                                 SOUND_MENU_DISPLAY_FLAGS_HIDE_INACTIVE_PLAYERS_PLAY_CONTROLS |
+                                 SOUND_MENU_DISPLAY_FLAGS_ADD_PLAY_CONTROL_INACTIVE_PLAYER));
+
+    gint64 mutations = indicator_sound_debug_metrics_get_value("batched-menu-mutations");
+    gint64 emissions = indicator_sound_debug_metrics_get_value("batched-menu-emissions");
+
+    std::vector<MediaPlayerMock *> players;
+    for (int i = 0; i < 2; i++) {
+        gchar * id = g_strdup_printf("player%d", i);
+        MediaPlayerMock * media = MEDIA_PLAYER_MOCK(
+            g_object_new(TYPE_MEDIA_PLAYER_MOCK,
+                "mock-id", id,
+                "mock-name", "Test Player",
+                "mock-state", "Paused",
+                "mock-is-running", FALSE,
+                "mock-can-raise", FALSE,
+                "mock-can-do-play", TRUE,
+                "mock-can-do-next", TRUE,
+                "mock-can-do-prev", TRUE,
+                NULL)
+        );
+        g_free(id);
+        sound_menu_add_player(menu, MEDIA_PLAYER(media));
+        players.push_back(media);
+    }
+
+    /* Start both players, play, get playlists, pause and stop */
+    for (auto media : players) {
+        g_object_set(media, "mock-is-running", TRUE, NULL);
+        g_object_notify(G_OBJECT(media), "is-running");
+    }
+    for (auto media : players) {
+        g_object_set(media, "mock-state", "Playing", NULL);
+        g_signal_emit_by_name(media, "playbackstatus-changed");
+        set_mock_playlists(media, {"/playlist/0", "/playlist/1"}, {"Playlist 0", "Playlist 1"});
+        g_object_set(media, "mock-state", "Paused", NULL);
+        g_signal_emit_by_name(media, "playbackstatus-changed");
+    }
+    for (auto media : players) {
+        g_object_set(media, "mock-is-running", FALSE, NULL);
+        g_object_notify(G_OBJECT(media), "is-running");
+    }
+
+    mutations = indicator_sound_debug_metrics_get_value("batched-menu-mutations") - mutations;
+    emissions = indicator_sound_debug_metrics_get_value("batched-menu-emissions") - emissions;
+    g_print("%" G_GINT64_FORMAT " items-changed signals for %" G_GINT64_FORMAT " menu mutations\n", emissions, mutations);
+    EXPECT_LT(emissions, mutations);
+
+    for (auto media : players) {
+        sound_menu_remove_player(menu, MEDIA_PLAYER(media));
+        g_clear_object(&media);
+    }
+    g_clear_object(&menu);
+}
+
+static void
+count_last_player_updated (SoundMenuCore * core, const gchar * player_id, gpointer user_data)
+{
+    (*static_cast<int *>(user_data))++;
+}
+
+TEST_F(SoundMenuTest, CoreUpdatesProfilesOnce) {
+    SoundMenuCore * core = sound_menu_core_new ();
+    SoundMenu * desktop = sound_menu_new ("indicator.desktop-settings", SOUND_MENU_DISPLAY_FLAGS_SHOW_MUTE);
+    SoundMenu * phone = sound_menu_new ("indicator.phone-settings", SOUND_MENU_DISPLAY_FLAGS_SHOW_SILENT_MODE);
+    sound_menu_core_add_profile(core, "desktop", desktop);
+    sound_menu_core_add_profile(core, "phone", phone);
+
+    GMenuModel * desktop_section = g_menu_model_get_item_link(G_MENU_MODEL(desktop->menu), 0, G_MENU_LINK_SECTION);
+    GMenuModel * phone_section = g_menu_model_get_item_link(G_MENU_MODEL(phone->menu), 0, G_MENU_LINK_SECTION);
+    int desktop_changes = 0;
+    int phone_changes = 0;
+    g_signal_connect(desktop_section, "items-changed", G_CALLBACK(count_items_changed), &desktop_changes);
+    g_signal_connect(phone_section, "items-changed", G_CALLBACK(count_items_changed), &phone_changes);
+
+    /* Each profile is updated once, and only when the label changes */
+    sound_menu_core_update_volume_slider(core, VOLUME_CONTROL_ACTIVE_OUTPUT_HEADPHONES);
+    sound_menu_core_update_volume_slider(core, VOLUME_CONTROL_ACTIVE_OUTPUT_HEADPHONES);
+    EXPECT_EQ(1, desktop_changes);
+    EXPECT_EQ(1, phone_changes);
+    verify_item_attribute(desktop_section, 1, "label", g_variant_new_string("Volume (Headphones)"));
+    verify_item_attribute(phone_section, 1, "label", g_variant_new_string("Volume (Headphones)"));
+
+    g_object_set(core, "show-mic-volume", TRUE, NULL);
+    g_object_set(core, "show-mic-volume", TRUE, NULL);
+    EXPECT_EQ(2, desktop_changes);
+    EXPECT_EQ(2, phone_changes);
+    EXPECT_TRUE(sound_menu_get_show_mic_volume(desktop));
+    EXPECT_TRUE(sound_menu_get_show_mic_volume(phone));
+
+    /* Both menus find the same last running player, it's reported once */
+    int last_player_updates = 0;
+    g_signal_connect(core, "last-player-updated", G_CALLBACK(count_last_player_updated), &last_player_updates);
+
+    MediaPlayerMock * media = MEDIA_PLAYER_MOCK(
+        g_object_new(TYPE_MEDIA_PLAYER_MOCK,
+            "mock-id", "player-id",
+            "mock-name", "Test Player",
+            "mock-state", "Paused",
+            "mock-is-running", FALSE,
+            "mock-can-raise", FALSE,
+            "mock-can-do-play", TRUE,
+            NULL)
+    );
+    sound_menu_core_add_player(core, MEDIA_PLAYER(media));
+    EXPECT_EQ(3, g_menu_model_get_n_items(G_MENU_MODEL(desktop->menu)));
+    EXPECT_EQ(3, g_menu_model_get_n_items(G_MENU_MODEL(phone->menu)));
+
+    g_object_set(media, "mock-is-running", TRUE, NULL);
+    g_object_notify(G_OBJECT(media), "is-running");
+    EXPECT_EQ(1, last_player_updates);
+    g_signal_handlers_disconnect_by_func(core, (gpointer) count_last_player_updated, &last_player_updates);
+
+    sound_menu_core_remove_player(core, MEDIA_PLAYER(media));
+    EXPECT_EQ(2, g_menu_model_get_n_items(G_MENU_MODEL(desktop->menu)));
+
+    g_signal_handlers_disconnect_by_func(desktop_section, (gpointer) count_items_changed, &desktop_changes);
+    g_signal_handlers_disconnect_by_func(phone_section, (gpointer) count_items_changed, &phone_changes);
+    g_object_unref(desktop_section);
+    g_object_unref(phone_section);
+
+    g_clear_object(&media);
+    g_clear_object(&core);
+    g_clear_object(&desktop);
+    g_clear_object(&phone);
+}
+
 TEST_F(SoundMenuTest, AddRemovePlayerNoPlayNextPrev) {
     check_player_control_buttons(false, false, false);
 }